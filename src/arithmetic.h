@@ -83,15 +83,18 @@ P reduce_exponent (N p, const P& m) {
  * @brief Given a polynomial p over GF(2) return whether it is irreducible
  *    with Ben-Or's algorithm.
  * @param p polynomial over GF(2)
+ * @param stop called before each round of the test; the test gives up,
+ *    returning false, once it returns true
  * @return true if p is irreducible.
  * @pre p is non-constant.
  */
-template <typename P>
-bool ben_or_test (const P& p) {
+template <typename P, typename Stop>
+bool ben_or_test (const P& p, Stop stop) {
   Expects(p.degree() > 0);
 
   auto             d = p.degree();
   for (decltype(d) i = 1; i <= d / 2; ++i) {
+    if (stop()) return false;
     auto b = reduce_exponent(i, p);
     auto g = gcd(p, b);
     if (g != one<P>) return false;
@@ -99,15 +102,26 @@ bool ben_or_test (const P& p) {
   return true;
 }
 
+template <typename P>
+bool ben_or_test (const P& p) {
+  return ben_or_test(p, [] () {return false;});
+}
+
 /**
  * @brief Given a polynomial p over GF(2), return whether it is irreducible.
  * @param p polynomial over GF(2)
+ * @param stop as for `ben_or_test`
  * @return true if p is irreducible.
  */
+template <typename P, typename Stop>
+bool is_irreducible (const P& p, Stop stop) {
+  if (p.degree() > 0) return ben_or_test(p, stop);
+  else return false;
+}
+
 template <typename P>
 bool is_irreducible (const P& p) {
-  if (p.degree() > 0) return ben_or_test(p);
-  else return false;
+  return is_irreducible(p, [] () {return false;});
 }
 
 }
@@ -0,0 +1,230 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "batch.h"
+#include "bytes.h"
+#include "cpu.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace satz::rabin {
+
+namespace {
+
+using Records = gsl::span<const gsl::span<const uint8_t>>;
+
+// Records at least this long are fingerprinted on their own by the table
+// kernels, and by the carry-less multiplication kernel, respectively.
+constexpr size_t long_record       = 2048;
+constexpr size_t clmul_long_record = 128;
+
+// Advances every lane by `steps` blocks of eight bytes, i.e. runs
+// slicing-by-8 on `L` inputs side by side.
+template <size_t L>
+void step_scalar (const Fingerprint* t,
+                  const uint8_t* const* p,
+                  Fingerprint* fp,
+                  size_t steps) {
+  Fingerprint f[L];
+  for (size_t l = 0; l < L; ++l) f[l] = fp[l];
+
+  for (size_t s = 0; s < steps; ++s) {
+    for (size_t l = 0; l < L; ++l) {
+      auto x = bytes::load_be64(p[l] + 8 * s);
+      f[l] = x
+             ^ t[0 * 256 + (f[l] & 0xff)] ^ t[1 * 256 + (f[l] >> 8 & 0xff)]
+             ^ t[2 * 256 + (f[l] >> 16 & 0xff)]
+             ^ t[3 * 256 + (f[l] >> 24 & 0xff)]
+             ^ t[4 * 256 + (f[l] >> 32 & 0xff)]
+             ^ t[5 * 256 + (f[l] >> 40 & 0xff)]
+             ^ t[6 * 256 + (f[l] >> 48 & 0xff)] ^ t[7 * 256 + (f[l] >> 56)];
+    }
+  }
+
+  for (size_t l = 0; l < L; ++l) fp[l] = f[l];
+}
+
+#if defined(__x86_64__)
+
+// Loads 16 bytes as a 128-bit polynomial whose leading coefficient is the
+// most significant bit of the first byte.
+__attribute__((target("pclmul,ssse3")))
+inline __m128i load_block (const uint8_t* p) {
+  const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15);
+  auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm_shuffle_epi8(x, reverse);
+}
+
+// Advances every lane by `steps` blocks of sixteen bytes with the folding
+// of `detail::fold_clmul`, one 128-bit accumulator per lane, followed by a
+// Barrett reduction per lane. `k` holds the constants filled in by
+// `detail::build_clmul_constants`.
+template <size_t L>
+__attribute__((target("pclmul,ssse3")))
+void step_clmul (const Fingerprint* k,
+                 Fingerprint m,
+                 const uint8_t* const* p,
+                 Fingerprint* fp,
+                 size_t steps) {
+  const __m128i k128 = _mm_set_epi64x(int64_t(k[1]), int64_t(k[0]));
+
+  __m128i acc[L];
+  for (size_t l = 0; l < L; ++l) acc[l] = _mm_cvtsi64_si128(int64_t(fp[l]));
+
+  for (size_t s = 0; s < steps; ++s) {
+    for (size_t l = 0; l < L; ++l) {
+      acc[l] = _mm_xor_si128(
+          _mm_xor_si128(_mm_clmulepi64_si128(acc[l], k128, 0x00),
+                        _mm_clmulepi64_si128(acc[l], k128, 0x11)),
+          load_block(p[l] + 16 * s));
+    }
+  }
+
+  const __m128i mu = _mm_set_epi64x(int64_t(m), int64_t(k[8]));
+  for (size_t l = 0; l < L; ++l) {
+    // q = hi + floor(hi * mu / x^64), then the remainder is lo + q * m.
+    __m128i hi = _mm_unpackhi_epi64(acc[l], acc[l]);
+    __m128i q  = _mm_xor_si128(
+        hi, _mm_srli_si128(_mm_clmulepi64_si128(hi, mu, 0x00), 8));
+    __m128i r  = _mm_xor_si128(acc[l], _mm_clmulepi64_si128(q, mu, 0x10));
+    fp[l] = Fingerprint(_mm_cvtsi128_si64(r));
+  }
+}
+
+#endif
+
+// Feeds the records to `L` lanes advanced together by `step`, in blocks of
+// `B` bytes. Whenever a lane has less than one block left, its record is
+// finished on its own and the lane moves on to the next record; once there
+// are too few records to fill every lane, the rest are finished one by one.
+// Records of `long_record` bytes or more never take a lane, as the
+// byte-range kernels find enough parallelism within them.
+template <size_t L, size_t B, typename Step>
+void schedule (const FingerprintGenerator& fg,
+               Fingerprint fp0,
+               Records records,
+               gsl::span<Fingerprint> out,
+               size_t long_record,
+               Step step) {
+  const uint8_t* p[L];
+  size_t         left[L];
+  size_t         id[L];
+  Fingerprint    fp[L];
+  size_t         next = 0;
+
+  // Loads the next record worth a lane into lane `l`.
+  auto refill = [&] (size_t l) {
+    while (next < size_t(records.size())) {
+      const size_t i = next++;
+      const auto&  r = records[i];
+      if (r.size() < B || r.size() >= long_record) {
+        out[i] = fg(fp0, r.data(), r.data() + r.size());
+        continue;
+      }
+      p[l]    = r.data();
+      left[l] = r.size();
+      id[l]   = i;
+      fp[l]   = fp0;
+      return true;
+    }
+    return false;
+  };
+
+  size_t active = 0;
+  while (active < L && refill(active)) ++active;
+
+  while (active == L) {
+    size_t steps = left[0] / B;
+    for (size_t l = 1; l < L; ++l) steps = std::min(steps, left[l] / B);
+
+    step(p, fp, steps);
+
+    for (size_t l = 0; l < active;) {
+      p[l] += B * steps;
+      left[l] -= B * steps;
+      if (left[l] >= B) {
+        ++l;
+        continue;
+      }
+      out[id[l]] = fg(fp[l], p[l], p[l] + left[l]);
+      if (refill(l)) {
+        ++l;
+        continue;
+      }
+      // Retire the lane. The last active lane takes its place and is
+      // advanced by the next iteration, as it has not been yet.
+      --active;
+      if (l == active) break;
+      p[l]    = p[active];
+      left[l] = left[active];
+      id[l]   = id[active];
+      fp[l]   = fp[active];
+    }
+  }
+
+  for (size_t l = 0; l < active; ++l) {
+    out[id[l]] = fg(fp[l], p[l], p[l] + left[l]);
+  }
+}
+
+}
+
+void fingerprint_many (const FingerprintGenerator& fg,
+                       Fingerprint fp,
+                       Records records,
+                       gsl::span<Fingerprint> out) {
+  if (cpu::has_pclmul()) {
+    return detail::fingerprint_many(fg, fp, records, out,
+                                    detail::batch_kernel::clmul);
+  }
+
+  // Lanes of table lookups do no better than slicing-by-16, which already
+  // keeps the load ports busy with independent lookups.
+  Expects(out.size() == records.size());
+  for (size_t i = 0; i < size_t(records.size()); ++i) {
+    out[i] = fg(fp, records[i].data(), records[i].data() + records[i].size());
+  }
+}
+
+namespace detail {
+
+void fingerprint_many (const FingerprintGenerator& fg,
+                       Fingerprint fp,
+                       Records records,
+                       gsl::span<Fingerprint> out,
+                       batch_kernel kernel) {
+  Expects(out.size() == records.size());
+
+  const Fingerprint* t = fg.tables().data();
+  using Lanes = const uint8_t* const*;
+
+  switch (kernel) {
+#if defined(__x86_64__)
+    case batch_kernel::clmul: {
+      Fingerprint k[9];
+      detail::build_clmul_constants(fg.polynomial(), t, k);
+      const Fingerprint m = fg.polynomial();
+      return schedule<8, 16>(
+          fg, fp, records, out, clmul_long_record,
+          [&] (Lanes p, Fingerprint* f, size_t n) {
+            step_clmul<8>(k, m, p, f, n);
+          });
+    }
+#endif
+    default:
+      return schedule<8, 8>(
+          fg, fp, records, out, long_record,
+          [t] (Lanes p, Fingerprint* f, size_t n) {
+            step_scalar<8>(t, p, f, n);
+          });
+  }
+}
+
+}
+
+}
@@ -0,0 +1,58 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Computes `out[i] = fg(fp, records[i].begin(), records[i].end())`
+ *    for every record.
+ *
+ *    Fingerprinting one short record is a chain of dependent operations
+ *    too short to keep the processor busy. Here eight records are in
+ *    flight at once, one per lane of an interleaved carry-less
+ *    multiplication kernel, when the processor supports it. A lane that
+ *    runs out of input takes the next record, so records of different
+ *    lengths keep every lane busy. Records long enough to have
+ *    parallelism of their own go through the byte-range kernels.
+ *
+ *    The interleaved table-lookup kernel is available through
+ *    `detail::fingerprint_many`, but does not beat slicing-by-16 on one
+ *    record at a time, which is limited by loads just as it is. Neither
+ *    did AVX2 or AVX-512 gathers of the same lookups.
+ *
+ * @pre out.size() == records.size()
+ */
+void fingerprint_many (const FingerprintGenerator& fg,
+                       Fingerprint fp,
+                       gsl::span<const gsl::span<const uint8_t>> records,
+                       gsl::span<Fingerprint> out);
+
+namespace detail {
+
+enum class batch_kernel {
+  scalar, // eight lanes of table lookups
+  clmul,  // eight lanes of carry-less multiplication
+};
+
+/**
+ * @brief `fingerprint_many` with the given kernel, for tests and
+ *    benchmarks.
+ * @pre the processor supports the kernel
+ */
+void fingerprint_many (const FingerprintGenerator& fg,
+                       Fingerprint fp,
+                       gsl::span<const gsl::span<const uint8_t>> records,
+                       gsl::span<Fingerprint> out,
+                       batch_kernel kernel);
+
+}
+
+}
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <bit>
+#include <cstring>
 #include <type_traits>
 #include <vector>
 #include <algorithm>
@@ -19,6 +21,19 @@ std::vector<uint8_t> make_random_bytes (int n);
 
 
 
+/**
+ * @brief Read 8 bytes as a big-endian integer, i.e. the first byte becomes
+ *    the most significant one. The pointer need not be aligned.
+ */
+inline uint64_t load_be64 (const uint8_t* p) {
+  uint64_t x;
+  std::memcpy(&x, p, sizeof(x));
+  if constexpr (std::endian::native == std::endian::little) {
+    x = __builtin_bswap64(x);
+  }
+  return x;
+}
+
 /**
  * @brief Given a byte sequence, return the indices of non-zero bits, regarding
  *    the bytes as a little-endian bit array with index starting at 0.
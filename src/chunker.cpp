@@ -0,0 +1,74 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "chunker.h"
+
+namespace satz::rabin {
+
+namespace {
+
+int log2_floor (size_t n) {
+  int i = -1;
+  while (n) {
+    n >>= 1;
+    ++i;
+  }
+  return i;
+}
+
+uint64_t low_bits_mask (int bits) {
+  return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+}
+
+}
+
+Chunker::Chunker (FingerprintGenerator fg, ChunkerConfig config)
+    : config_(config), rolling_(std::move(fg), config.window) {
+
+  Expects(config_.window > 0);
+  Expects(config_.window <= config_.min_size);
+  Expects(config_.min_size <= config_.avg_size);
+  Expects(config_.avg_size <= config_.max_size);
+  Expects(config_.normalization >= 0);
+
+  const int bits = log2_floor(config_.avg_size);
+  Expects(bits - config_.normalization > 0);
+
+  mask_s_ = low_bits_mask(bits + config_.normalization);
+  mask_l_ = low_bits_mask(bits - config_.normalization);
+}
+
+size_t Chunker::next_cut (gsl::span<const uint8_t> bytes) const {
+  const size_t n = bytes.size();
+  if (n <= config_.min_size) return n;
+
+  const size_t   limit  = std::min(n, config_.max_size);
+  const size_t   normal = std::min(config_.avg_size, limit);
+  const size_t   w      = config_.window;
+  const uint8_t* p      = bytes.data();
+
+  // Skip ahead to the first window that may end a chunk.
+  size_t      i  = config_.min_size;
+  Fingerprint fp = rolling_(bytes.subspan(i - w));
+
+  for (; i < normal; ++i) {
+    if (!(fp & mask_s_)) return i;
+    fp = rolling_.roll(fp, p[i - w], p[i]);
+  }
+  for (; i < limit; ++i) {
+    if (!(fp & mask_l_)) return i;
+    fp = rolling_.roll(fp, p[i - w], p[i]);
+  }
+  return limit;
+}
+
+std::vector<size_t> Chunker::cut_points (gsl::span<const uint8_t> bytes) const {
+  std::vector<size_t> ret;
+  ret.reserve(bytes.size() / config_.avg_size + 1);
+  cut_points(bytes, std::back_inserter(ret));
+  return ret;
+}
+
+}
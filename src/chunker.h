@@ -0,0 +1,125 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+#include <gsl/gsl>
+#include "fingerprint.h"
+#include "rolling.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Parameters of content-defined chunking.
+ *
+ *    Chunks are at least `min_size` and at most `max_size` bytes long, and
+ *    about `avg_size` bytes long on average. With `normalization` set to
+ *    $n > 0$, a cut before `avg_size` needs $n$ more zero bits of the
+ *    fingerprint than usual and a cut after it $n$ fewer, which narrows
+ *    the distribution of chunk sizes around the average.
+ */
+struct ChunkerConfig {
+  size_t min_size      = 2 * 1024;
+  size_t avg_size      = 8 * 1024;
+  size_t max_size      = 64 * 1024;
+  int    normalization = 2;
+  size_t window        = 48;
+};
+
+/**
+ * @brief Content-defined chunker driven by rolling Rabin fingerprints.
+ *
+ *    A chunk ends after the first byte at which the fingerprint of the
+ *    preceding `window` bytes has all its mask bits zero. The first
+ *    `min_size - window` bytes of each chunk are never hashed, since no cut
+ *    may fall there.
+ */
+class Chunker {
+public:
+  /**
+   * @pre 0 < config.window <= config.min_size <= config.avg_size
+   *    <= config.max_size, and the average size is large enough for the
+   *    normalization level.
+   */
+  explicit Chunker (FingerprintGenerator fg, ChunkerConfig config = {});
+
+  [[nodiscard]] const ChunkerConfig& config () const {return config_;}
+
+  [[nodiscard]] uint64_t small_mask () const {return mask_s_;}
+
+  [[nodiscard]] uint64_t large_mask () const {return mask_l_;}
+
+  /**
+   * @brief Returns the length of the first chunk of `bytes`.
+   *
+   *    `bytes` is assumed to start at a chunk boundary. If it is shorter
+   *    than `max_size`, the returned cut may only be final once the end of
+   *    the stream is reached.
+   */
+  [[nodiscard]] size_t next_cut (gsl::span<const uint8_t> bytes) const;
+
+  /**
+   * @brief Writes the end offset of every chunk of `bytes`; the last one is
+   *    always `bytes.size()` unless `bytes` is empty.
+   * @return output iterator past the last written offset
+   */
+  template <typename OutputIt>
+  OutputIt cut_points (gsl::span<const uint8_t> bytes, OutputIt out) const {
+    size_t pos = 0;
+    while (pos < size_t(bytes.size())) {
+      pos += next_cut(bytes.subspan(pos));
+      *out++ = pos;
+    }
+    return out;
+  }
+
+  [[nodiscard]] std::vector<size_t> cut_points (
+      gsl::span<const uint8_t> bytes) const;
+
+  /**
+   * @brief Reads `in` to the end and calls `f` with every chunk, as a
+   *    `gsl::span<const uint8_t>` that is only valid during the call.
+   * @return total number of bytes read
+   */
+  template <typename F>
+  uint64_t for_each_chunk (std::istream& in, F f) const {
+    std::vector<uint8_t> buffer(4 * config_.max_size);
+    size_t   begin = 0;
+    size_t   end   = 0;
+    uint64_t total = 0;
+    bool     eof   = false;
+
+    while (true) {
+      if (!eof && end - begin < config_.max_size) {
+        std::copy(buffer.begin() + begin, buffer.begin() + end, buffer.begin());
+        end -= begin;
+        begin = 0;
+        in.read(reinterpret_cast<char*>(buffer.data() + end),
+                std::streamsize(buffer.size() - end));
+        end += size_t(in.gcount());
+        eof = !in;
+      }
+      if (begin == end) break;
+
+      gsl::span<const uint8_t> rest(buffer.data() + begin, end - begin);
+      size_t len = next_cut(rest);
+      f(rest.first(len));
+      begin += len;
+      total += len;
+    }
+    return total;
+  }
+
+private:
+  ChunkerConfig      config_;
+  RollingFingerprint rolling_;
+  uint64_t           mask_s_; // used before `avg_size`, harder to match
+  uint64_t           mask_l_; // used after `avg_size`, easier to match
+};
+
+}
@@ -0,0 +1,40 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "cpu.h"
+
+namespace satz::cpu {
+
+bool has_pclmul () {
+#if defined(__x86_64__)
+  static const bool supported =
+                        __builtin_cpu_supports("pclmul") &&
+                        __builtin_cpu_supports("ssse3");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool has_avx512 () {
+#if defined(__x86_64__)
+  static const bool supported = __builtin_cpu_supports("avx512f");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+bool has_vpclmul () {
+#if defined(__x86_64__)
+  static const bool supported = __builtin_cpu_supports("avx512f") &&
+                                __builtin_cpu_supports("vpclmulqdq");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+}
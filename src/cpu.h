@@ -0,0 +1,29 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+namespace satz::cpu {
+
+/**
+ * @brief Returns whether the processor supports carry-less multiplication
+ *    (PCLMULQDQ) along with the SSSE3 byte shuffles used around it.
+ */
+bool has_pclmul ();
+
+/**
+ * @brief Returns whether the processor supports the AVX-512 foundation
+ *    instructions (AVX512F), which the benchmarks report as part of the
+ *    machine they ran on.
+ */
+bool has_avx512 ();
+
+/**
+ * @brief Returns whether the processor supports carry-less multiplication
+ *    of 512-bit vectors (VPCLMULQDQ with AVX-512).
+ */
+bool has_vpclmul ();
+
+}
@@ -0,0 +1,655 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "dense_polynomial.h"
+#include "bytes.h"
+#include "cpu.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <boost/lexical_cast.hpp>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace satz::gf2::v3 {
+
+namespace {
+
+using word_type = Polynomial::word_type;
+constexpr int word_bits = 64;
+
+// Carry-less product of two words, as (low word, high word).
+std::pair<word_type, word_type> clmul_portable (word_type a, word_type b) {
+  // multiples of `a` by every polynomial of degree below 4
+  word_type tl[16], th[16];
+  tl[0] = th[0] = 0;
+  tl[1] = a;
+  th[1] = 0;
+  for (int i = 2; i < 16; i += 2) {
+    tl[i]     = tl[i / 2] << 1;
+    th[i]     = (th[i / 2] << 1) | (tl[i / 2] >> 63);
+    tl[i + 1] = tl[i] ^ a;
+    th[i + 1] = th[i];
+  }
+
+  word_type lo = 0, hi = 0;
+  for (int s = word_bits - 4; s >= 0; s -= 4) {
+    hi = (hi << 4) | (lo >> 60);
+    lo = lo << 4;
+    auto nibble = (b >> s) & 0xf;
+    lo ^= tl[nibble];
+    hi ^= th[nibble];
+  }
+  return {lo, hi};
+}
+
+// XORs `d << shift` into `r`, which must be large enough.
+void xor_shifted (Polynomial::container_type& r,
+                  const Polynomial::container_type& d,
+                  int shift) {
+  const int q = shift / word_bits;
+  const int s = shift % word_bits;
+  if (s == 0) {
+    for (size_t i = 0; i < d.size(); ++i) r[q + i] ^= d[i];
+  } else {
+    for (size_t i = 0; i < d.size(); ++i) {
+      r[q + i] ^= d[i] << s;
+      if (q + i + 1 < r.size()) r[q + i + 1] ^= d[i] >> (word_bits - s);
+    }
+  }
+}
+
+using container_type = Polynomial::container_type;
+
+// Below this many words, Karatsuba's method costs more than it saves.
+constexpr size_t karatsuba_threshold = 24;
+
+// Below this degree of the divisor, Barrett reduction costs more than it
+// saves.
+constexpr int barrett_threshold = 128;
+
+// XORs the product of `a` and `b`, of `na` and `nb` words, into `r`, of
+// `na + nb` words.
+using basecase_fn = void (*) (const word_type* a, size_t na,
+                              const word_type* b, size_t nb,
+                              word_type* r);
+
+void basecase_portable (const word_type* a, size_t na,
+                        const word_type* b, size_t nb,
+                        word_type* r) {
+  for (size_t i = 0; i < na; ++i) {
+    for (size_t j = 0; j < nb; ++j) {
+      auto [lo, hi] = clmul_portable(a[i], b[j]);
+      r[i + j] ^= lo;
+      r[i + j + 1] ^= hi;
+    }
+  }
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("pclmul,sse4.1")))
+void basecase_native (const word_type* a, size_t na,
+                      const word_type* b, size_t nb,
+                      word_type* r) {
+  for (size_t i = 0; i < na; ++i) {
+    const __m128i x     = _mm_cvtsi64_si128(int64_t(a[i]));
+    __m128i       carry = _mm_setzero_si128();
+    for (size_t j = 0; j < nb; ++j) {
+      __m128i p = _mm_clmulepi64_si128(
+          x, _mm_cvtsi64_si128(int64_t(b[j])), 0x00);
+      p = _mm_xor_si128(p, carry);
+      r[i + j] ^= word_type(_mm_cvtsi128_si64(p));
+      carry = _mm_srli_si128(p, 8);
+    }
+    r[i + nb] ^= word_type(_mm_cvtsi128_si64(carry));
+  }
+}
+
+#endif
+
+basecase_fn select_basecase () {
+#if defined(__x86_64__)
+  if (cpu::has_pclmul()) return basecase_native;
+#endif
+  return basecase_portable;
+}
+
+const basecase_fn basecase = select_basecase();
+
+// Words of scratch space needed by `karatsuba` for `n` words.
+size_t karatsuba_scratch (size_t n) {
+  if (n < karatsuba_threshold) return 0;
+  const size_t m = n - n / 2;
+  return 4 * m + karatsuba_scratch(m);
+}
+
+// Writes the product of `a` and `b`, of `n` words each, to `r`, of `2n`
+// words, with `t` as scratch space.
+void karatsuba (const word_type* a, const word_type* b, size_t n,
+                word_type* r, word_type* t) {
+  if (n < karatsuba_threshold) {
+    std::fill(r, r + 2 * n, 0);
+    basecase(a, n, b, n, r);
+    return;
+  }
+
+  // a = a0 + a1 x^{64h} and b = b0 + b1 x^{64h}, where a0 and b0 have `h`
+  // words and a1 and b1 have `m >= h`. The middle term is
+  // (a0 + a1)(b0 + b1) - a0 b0 - a1 b1.
+  const size_t h  = n / 2;
+  const size_t m  = n - h;
+  word_type*   sa = t;
+  word_type*   sb = t + m;
+  word_type*   p1 = t + 2 * m;
+  for (size_t i = 0; i < m; ++i) {
+    sa[i] = a[h + i] ^ (i < h ? a[i] : 0);
+    sb[i] = b[h + i] ^ (i < h ? b[i] : 0);
+  }
+  karatsuba(sa, sb, m, p1, t + 4 * m);
+  karatsuba(a, b, h, r, t + 4 * m);
+  karatsuba(a + h, b + h, m, r + 2 * h, t + 4 * m);
+
+  for (size_t i = 0; i < 2 * h; ++i) p1[i] ^= r[i];
+  for (size_t i = 0; i < 2 * m; ++i) p1[i] ^= r[2 * h + i];
+  for (size_t i = 0; i < 2 * m; ++i) r[h + i] ^= p1[i];
+}
+
+container_type multiply (const container_type& a,
+                         const container_type& b,
+                         detail::multiplication method) {
+  if (a.empty() || b.empty()) return {};
+
+  const bool      swap = a.size() < b.size();
+  const auto&     x    = swap ? b : a; // the longer one
+  const auto&     y    = swap ? a : b;
+  const size_t    n    = y.size();
+  container_type  r(x.size() + n, 0);
+  if (method == detail::multiplication::schoolbook
+      || n < karatsuba_threshold) {
+    basecase(x.data(), x.size(), y.data(), n, r.data());
+    return r;
+  }
+
+  // Slices of `x` as long as `y`, the last one padded with zeros.
+  container_type t(karatsuba_scratch(n));
+  container_type slice(n), product(2 * n);
+  for (size_t o = 0; o < x.size(); o += n) {
+    const size_t    len = std::min(n, x.size() - o);
+    const word_type* s  = x.data() + o;
+    if (len < n) {
+      std::copy(s, s + len, slice.begin());
+      std::fill(slice.begin() + ptrdiff_t(len), slice.end(), 0);
+      s = slice.data();
+    }
+    karatsuba(s, y.data(), n, product.data(), t.data());
+    for (size_t i = 0; i < 2 * n && o + i < r.size(); ++i) {
+      r[o + i] ^= product[i];
+    }
+  }
+  return r;
+}
+
+void trim (container_type& w) {
+  while (!w.empty() && w.back() == 0) w.pop_back();
+}
+
+// Returns the coefficients of $x^0$ to $x^{bits-1}$.
+container_type truncate (const container_type& w, size_t bits) {
+  const size_t   n = std::min(w.size(), (bits + word_bits - 1) / word_bits);
+  container_type r(w.begin(), w.begin() + ptrdiff_t(n));
+  if (n == (bits + word_bits - 1) / word_bits && bits % word_bits) {
+    r.back() &= (word_type(1) << (bits % word_bits)) - 1;
+  }
+  trim(r);
+  return r;
+}
+
+// Returns `w` divided by $x^{bits}$, rounded down.
+container_type shift_right (const container_type& w, size_t bits) {
+  const size_t q = bits / word_bits;
+  const int    s = int(bits % word_bits);
+  if (q >= w.size()) return {};
+
+  container_type r(w.size() - q);
+  for (size_t i = 0; i < r.size(); ++i) {
+    r[i] = w[q + i] >> s;
+    if (s && q + i + 1 < w.size()) r[i] |= w[q + i + 1] << (word_bits - s);
+  }
+  trim(r);
+  return r;
+}
+
+word_type reverse_bits (word_type x) {
+  x = ((x >> 1) & 0x5555555555555555) | ((x & 0x5555555555555555) << 1);
+  x = ((x >> 2) & 0x3333333333333333) | ((x & 0x3333333333333333) << 2);
+  x = ((x >> 4) & 0x0f0f0f0f0f0f0f0f) | ((x & 0x0f0f0f0f0f0f0f0f) << 4);
+  return __builtin_bswap64(x);
+}
+
+// Returns $x^{bits-1} w(1/x)$, i.e. the coefficients of $x^0$ to
+// $x^{bits-1}$ in reverse order.
+container_type reverse (const container_type& w, size_t bits) {
+  const size_t   n = (bits + word_bits - 1) / word_bits;
+  container_type r(n, 0);
+  for (size_t i = 0; i < n && i < w.size(); ++i) {
+    r[n - 1 - i] = reverse_bits(w[i]);
+  }
+  return shift_right(r, n * word_bits - bits);
+}
+
+// A divisor of degree `d` and $\mu = \lfloor x^{2d} / m \rfloor$.
+struct Barrett {
+  container_type m;
+  container_type mu;
+  size_t         d = 0;
+};
+
+Barrett make_barrett (const container_type& m, size_t d) {
+  // $\mu$ reversed is the inverse of `m` reversed modulo $x^{d+1}$, found
+  // by Newton iteration: if $f g = 1 + e x^k$, then $f (f g^2) = 1 + e^2
+  // x^{2k}$ over GF(2).
+  const auto     f = reverse(m, d + 1);
+  container_type g = {1};
+  for (size_t k = 1; k < d + 1;) {
+    k = std::min(2 * k, d + 1);
+    g = truncate(multiply(multiply(g, g, detail::multiplication::karatsuba),
+                          truncate(f, k),
+                          detail::multiplication::karatsuba),
+                 k);
+  }
+  return {m, reverse(g, d + 1), d};
+}
+
+// Returns `a` modulo the divisor. With $a = a_1 x^d + a_0$ of degree below
+// $2d$, the quotient is exactly $\lfloor a_1 \mu / x^d \rfloor$; higher
+// degrees are reduced by $d$ at a time from the top.
+container_type barrett_reduce (const Barrett& b, container_type a) {
+  using detail::multiplication;
+
+  trim(a);
+  const size_t d = b.d;
+  while (!a.empty()) {
+    const size_t deg = (a.size() - 1) * word_bits + word_bits - 1
+                       - size_t(std::countl_zero(a.back()));
+    if (deg < d) break;
+
+    // the top 2d coefficients, as a polynomial of degree below 2d
+    const size_t   s   = deg + 1 > 2 * d ? deg + 1 - 2 * d : 0;
+    const auto     top = shift_right(a, s);
+    const auto     q   = shift_right(
+        multiply(shift_right(top, d), b.mu, multiplication::karatsuba), d);
+    const auto     qm  = multiply(q, b.m, multiplication::karatsuba);
+    container_type r   = truncate(top, d);
+    const auto     low = truncate(qm, d);
+    if (r.size() < low.size()) r.resize(low.size(), 0);
+    for (size_t i = 0; i < low.size(); ++i) r[i] ^= low[i];
+
+    // a = a mod x^s + r x^s
+    container_type next = truncate(a, s);
+    next.resize(std::max(next.size(), r.size() + s / word_bits + 2), 0);
+    xor_shifted(next, r, int(s));
+    trim(next);
+    a.swap(next);
+  }
+  return a;
+}
+
+// Barrett constants of the last divisor used on this thread, since
+// remainders by the same divisor tend to come in long runs, as in
+// `mod_pow` and `ben_or_test`.
+const Barrett& barrett_of (const container_type& m, size_t d) {
+  thread_local Barrett last;
+  if (last.m != m) last = make_barrett(m, d);
+  return last;
+}
+
+}
+
+Polynomial Polynomial::from_ulong (unsigned long l) {
+  static_assert(sizeof(l) == 8);
+  return Polynomial(container_type{word_type(l)});
+}
+
+Polynomial Polynomial::from_bytes (gsl::span<uint8_t> bytes) {
+  container_type w((bytes.size() + 7) / 8, 0);
+  for (size_t i = 0; i < size_t(bytes.size()); ++i) {
+    w[i / 8] |= word_type(bytes[i]) << (8 * (i % 8));
+  }
+  return Polynomial(std::move(w));
+}
+
+Polynomial Polynomial::from_bytes (gsl::span<uint8_t> bytes,
+    Polynomial::int_type degree) {
+
+  Expects(int64_t(bytes.size()) * 8 > degree);
+
+  auto ret = from_bytes(bytes);
+  ret.w_.resize(degree / word_bits + 1, 0);
+  ret.w_.back() &= (word_type(1) << (degree % word_bits)) - 1;
+  ret.set(degree);
+  return ret;
+}
+
+Polynomial Polynomial::make_random (Polynomial::int_type degree) {
+  auto bytes = satz::bytes::make_random_bytes(static_cast<int>(degree / 8 + 1));
+  return Polynomial::from_bytes(bytes, degree);
+}
+
+Polynomial Polynomial::make_irreducible (Polynomial::int_type degree) {
+  Expects(degree > 0);
+
+  // See `v2::Polynomial::make_irreducible` for the number of trials.
+  int magic_number = 15;
+  auto trials = degree * magic_number;
+  while (trials-- > 0) {
+    auto p = Polynomial::make_random(degree);
+    if (is_irreducible(p)) return p;
+  }
+
+  throw std::runtime_error("fail to obtain an irreducible polynomial");
+}
+
+Polynomial Polynomial::make_irreducible (Polynomial::int_type degree,
+                                         uint64_t seed) {
+  return make_irreducible(degree, seed, 1);
+}
+
+Polynomial Polynomial::make_irreducible (Polynomial::int_type degree,
+                                         uint64_t seed,
+                                         unsigned threads) {
+  Expects(degree > 0 && threads > 0);
+
+  // The output of `std::mt19937_64` is fixed by the standard. Candidates
+  // are numbered in the order they are drawn, which takes far less time
+  // than testing them, under the lock; the lowest-numbered irreducible one
+  // wins, whichever thread finds it first. Candidates numbered after one
+  // found irreducible are dropped between rounds of their test.
+  std::mt19937_64 engine(seed);
+  int magic_number = 15;
+  const int64_t        trials = int64_t(degree) * magic_number;
+  std::mutex           mutex;
+  int64_t              next  = 0;      // guarded by `mutex`
+  std::atomic<int64_t> found = trials; // written under `mutex`
+  Polynomial           ret;            // guarded by `mutex`
+
+  auto search = [&] () {
+    while (true) {
+      container_type w(degree / word_bits + 1);
+      int64_t        index;
+      {
+        std::lock_guard lock(mutex);
+        if (next >= found) return;
+        index = next++;
+        for (auto& x : w) x = engine();
+      }
+      w.back() &= (word_type(1) << (degree % word_bits)) - 1;
+      Polynomial p(std::move(w));
+      p.set(degree);
+      const auto beaten = [&found, index] () {
+        return found.load(std::memory_order_relaxed) < index;
+      };
+      if (!is_irreducible(p, beaten)) continue;
+
+      std::lock_guard lock(mutex);
+      if (index < found) {
+        found = index;
+        ret   = std::move(p);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned i = 1; i < threads; ++i) workers.emplace_back(search);
+  search();
+  for (auto& w : workers) w.join();
+
+  if (found == trials) {
+    throw std::runtime_error("fail to obtain an irreducible polynomial");
+  }
+  return ret;
+}
+
+std::vector<uint8_t> Polynomial::to_bytes () const {
+  const int d = degree();
+  const size_t count = (d >= 0) ? (d / 8 + 1) : 0;
+
+  std::vector<uint8_t> ret(count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    ret[i] = uint8_t(w_[i / 8] >> (8 * (i % 8)));
+  }
+  return ret;
+}
+
+Polynomial::operator bool () const {return !empty();}
+
+bool operator == (const Polynomial& lhs, const Polynomial& rhs) {
+  return lhs.w_ == rhs.w_;
+}
+
+bool operator != (const Polynomial& lhs, const Polynomial& rhs) {
+  return !(rhs == lhs);
+}
+
+Polynomial& Polynomial::operator ^= (const Polynomial& rhs) {
+  if (w_.size() < rhs.w_.size()) w_.resize(rhs.w_.size(), 0);
+  for (size_t i = 0; i < rhs.w_.size(); ++i) w_[i] ^= rhs.w_[i];
+  trim();
+  return *this;
+}
+
+Polynomial& Polynomial::operator |= (const Polynomial& rhs) {
+  if (w_.size() < rhs.w_.size()) w_.resize(rhs.w_.size(), 0);
+  for (size_t i = 0; i < rhs.w_.size(); ++i) w_[i] |= rhs.w_[i];
+  return *this;
+}
+
+Polynomial& Polynomial::operator &= (const Polynomial& rhs) {
+  if (w_.size() > rhs.w_.size()) w_.resize(rhs.w_.size());
+  for (size_t i = 0; i < w_.size(); ++i) w_[i] &= rhs.w_[i];
+  trim();
+  return *this;
+}
+
+Polynomial& Polynomial::operator += (const Polynomial& rhs) {
+  return *this ^= rhs;
+}
+
+Polynomial& Polynomial::operator -= (const Polynomial& rhs) {
+  return *this ^= rhs;
+}
+
+Polynomial& Polynomial::operator *= (const Polynomial& rhs) {
+  Polynomial res = *this * rhs;
+  w_.swap(res.w_);
+  return *this;
+}
+
+Polynomial& Polynomial::operator %= (const Polynomial& rhs) {
+  Expects(!rhs.empty());
+
+  using detail::reduction;
+  auto method = rhs.degree() >= barrett_threshold ? reduction::barrett
+                                                   : reduction::bitwise;
+  Polynomial res = detail::remainder(*this, rhs, method);
+  w_.swap(res.w_);
+  return *this;
+}
+
+Polynomial& Polynomial::operator <<= (Polynomial::int_type n) {
+  Expects(n >= 0);
+  Polynomial res = *this << n;
+  w_.swap(res.w_);
+  return *this;
+}
+
+Polynomial& Polynomial::operator >>= (Polynomial::int_type n) {
+  Expects(n >= 0);
+  Polynomial res = *this >> n;
+  w_.swap(res.w_);
+  return *this;
+}
+
+Polynomial operator ^ (const Polynomial& lhs, const Polynomial& rhs) {
+  Polynomial ret(lhs);
+  return ret ^= rhs;
+}
+
+Polynomial operator | (const Polynomial& lhs, const Polynomial& rhs) {
+  Polynomial ret(lhs);
+  return ret |= rhs;
+}
+
+Polynomial operator & (const Polynomial& lhs, const Polynomial& rhs) {
+  Polynomial ret(lhs);
+  return ret &= rhs;
+}
+
+Polynomial operator + (const Polynomial& lhs, const Polynomial& rhs) {
+  return lhs ^ rhs;
+}
+
+Polynomial operator - (const Polynomial& lhs, const Polynomial& rhs) {
+  return lhs ^ rhs;
+}
+
+Polynomial operator * (const Polynomial& lhs, const Polynomial& rhs) {
+  return detail::multiply(lhs, rhs, detail::multiplication::karatsuba);
+}
+
+Polynomial Polynomial::operator << (Polynomial::int_type n) const {
+  Expects(n >= 0);
+  if (empty()) return {};
+
+  container_type r(w_.size() + n / word_bits + 1, 0);
+  xor_shifted(r, w_, n);
+  return Polynomial(std::move(r));
+}
+
+Polynomial Polynomial::operator >> (Polynomial::int_type n) const {
+  Expects(n >= 0);
+
+  const size_t q = n / word_bits;
+  const int    s = n % word_bits;
+  if (q >= w_.size()) return {};
+
+  container_type r(w_.size() - q, 0);
+  for (size_t i = 0; i < r.size(); ++i) {
+    r[i] = w_[q + i] >> s;
+    if (s && q + i + 1 < w_.size()) r[i] |= w_[q + i + 1] << (word_bits - s);
+  }
+  return Polynomial(std::move(r));
+}
+
+Polynomial operator % (const Polynomial& lhs, const Polynomial& rhs) {
+  Polynomial ret(lhs);
+  return ret %= rhs;
+}
+
+std::ostream& operator << (std::ostream& os, const Polynomial& obj) {
+  if (obj.empty()) return os << "0";
+
+  bool first = true;
+  for (auto n = obj.degree(); n >= 0; --n) {
+    if (!obj.contains(n)) continue;
+    if (!first) os << "+";
+    first = false;
+    if (n > 1) os << "x^" << boost::lexical_cast<std::string>(n);
+    else if (n == 1) os << "x";
+    else os << "1";
+  }
+  return os;
+}
+
+bool Polynomial::empty () const {return w_.empty();}
+
+Polynomial::int_type Polynomial::degree () const {
+  if (empty()) return -1;
+  return int_type(w_.size() - 1) * word_bits
+         + (word_bits - 1 - std::countl_zero(w_.back()));
+}
+
+Polynomial::int_type Polynomial::nnz () const {
+  int_type n = 0;
+  for (auto w : w_) n += std::popcount(w);
+  return n;
+}
+
+bool Polynomial::contains (Polynomial::int_type n) const {
+  if (n < 0 || size_t(n / word_bits) >= w_.size()) return false;
+  return (w_[n / word_bits] >> (n % word_bits)) & 0x1;
+}
+
+Polynomial::Polynomial (Polynomial::container_type&& w) : w_(std::move(w)) {
+  trim();
+}
+
+void Polynomial::set (Polynomial::int_type n) {
+  Expects(n >= 0);
+  if (size_t(n / word_bits) >= w_.size()) w_.resize(n / word_bits + 1, 0);
+  w_[n / word_bits] |= word_type(1) << (n % word_bits);
+}
+
+void Polynomial::trim () {
+  while (!w_.empty() && w_.back() == 0) w_.pop_back();
+}
+
+bool operator < (const Polynomial& lhs, const Polynomial& rhs) {
+  if (lhs.w_.size() != rhs.w_.size()) return lhs.w_.size() < rhs.w_.size();
+  return std::lexicographical_compare(lhs.w_.rbegin(),
+                                      lhs.w_.rend(),
+                                      rhs.w_.rbegin(),
+                                      rhs.w_.rend());
+}
+
+bool operator > (const Polynomial& lhs, const Polynomial& rhs) {
+  return rhs < lhs;
+}
+
+bool operator <= (const Polynomial& lhs, const Polynomial& rhs) {
+  return !(rhs < lhs);
+}
+
+bool operator >= (const Polynomial& lhs, const Polynomial& rhs) {
+  return !(lhs < rhs);
+}
+
+namespace detail {
+
+Polynomial multiply (const Polynomial& a,
+                     const Polynomial& b,
+                     multiplication method) {
+  return Polynomial(v3::multiply(a.w_, b.w_, method));
+}
+
+Polynomial remainder (const Polynomial& a,
+                      const Polynomial& m,
+                      reduction method) {
+  Expects(!m.empty());
+
+  const Polynomial::int_type d = m.degree();
+  if (a.degree() < d) return a;
+  if (method == reduction::barrett && d > 0) {
+    return Polynomial(barrett_reduce(barrett_of(m.w_, size_t(d)), a.w_));
+  }
+
+  Polynomial ret(a);
+  for (auto i = ret.degree(); i >= d; --i) {
+    if (ret.contains(i)) xor_shifted(ret.w_, m.w_, i - d);
+  }
+  ret.trim();
+  return ret;
+}
+
+}
+
+}
@@ -0,0 +1,209 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+#include <vector>
+#include <gsl/gsl>
+#include "arithmetic.h"
+
+namespace satz::gf2::v3 {
+
+class Polynomial;
+
+namespace detail {
+
+enum class multiplication {
+  schoolbook, // every pair of words, $O(n^2)$
+  karatsuba,  // three half-size products per level, $O(n^{1.58})$
+};
+
+enum class reduction {
+  bitwise, // one shifted subtraction of the divisor per bit of quotient
+  barrett, // two products with a precomputed inverse of the divisor
+};
+
+/**
+ * @brief Returns `a * b` computed by the given method, for tests and
+ *    benchmarks.
+ */
+Polynomial multiply (const Polynomial& a,
+                     const Polynomial& b,
+                     multiplication method);
+
+/**
+ * @brief Returns `a % m` computed by the given method, for tests and
+ *    benchmarks.
+ * @pre m is not zero
+ */
+Polynomial remainder (const Polynomial& a,
+                      const Polynomial& m,
+                      reduction method);
+
+}
+
+/**
+ * @brief Polynomial over GF(2), stored densely as 64-bit words.
+ *
+ *    The coefficient of $x^n$ is bit `n % 64` of word `n / 64`, and the
+ *    most significant word is never zero. Addition and shifts work on whole
+ *    words and multiplication on carry-less products of words, so this is
+ *    the representation of choice unless the polynomial is very sparse.
+ *    The interface is the one of `v2::Polynomial`.
+ *
+ *    Products of large polynomials are computed by Karatsuba's method down
+ *    to a schoolbook base case, and remainders by large divisors by Barrett
+ *    reduction, with the inverse of the divisor computed by Newton
+ *    iteration and kept for the next remainder by the same divisor on the
+ *    thread. The crossovers are measured by `fingerprint.bench`.
+ */
+class Polynomial {
+public:
+  using int_type = int;
+  using word_type = uint64_t;
+  using container_type = std::vector<word_type>;
+
+  Polynomial () = default;
+
+  template <typename T>
+  Polynomial (std::initializer_list<T> degrees)
+      : Polynomial(degrees.begin(), degrees.end()) { }
+
+  template <typename InputIt>
+  Polynomial (InputIt first, InputIt last) {
+    Expects(std::all_of(first, last, [] (const auto& x) { return x >= 0; }));
+    std::for_each(first, last, [this] (int_type n) { set(n); });
+  }
+
+  static Polynomial from_ulong (unsigned long);
+  static Polynomial from_bytes (gsl::span<uint8_t>);
+  static Polynomial from_bytes (gsl::span<uint8_t>, int_type degree);
+  static Polynomial make_random (int_type degree);
+  static Polynomial make_irreducible (int_type degree);
+
+  /**
+   * @brief Returns an irreducible polynomial of the given degree drawn from
+   *    a pseudo-random sequence, i.e. the same one for the same seed on
+   *    every platform.
+   */
+  static Polynomial make_irreducible (int_type degree, uint64_t seed);
+
+  /**
+   * @brief Returns `make_irreducible(degree, seed)`, testing the candidates
+   *    on several threads.
+   *
+   *    The candidates are drawn in order from the same sequence, and the
+   *    first irreducible one of the sequence is the result: once one is
+   *    found, no later candidate is taken up, the tests of later ones
+   *    under way are dropped, and the threads finish testing the earlier
+   *    ones.
+   *
+   * @param threads number of threads, including the calling one
+   * @pre degree > 0 and threads > 0
+   */
+  static Polynomial make_irreducible (int_type degree,
+                                      uint64_t seed,
+                                      unsigned threads);
+
+  /**
+   * @brief Return a bit representation of the coefficients.
+   *
+   *    When the degree of this polynomial is -1, return an empty vector.
+   *    In other cases, return a bit representation with just enough bytes,
+   *    i.e., the most significant byte should be non-zero.
+   */
+  [[nodiscard]] std::vector<uint8_t> to_bytes () const;
+
+  /**
+   * @brief Return the coefficients as words, least significant first.
+   */
+  [[nodiscard]] const container_type& words () const {return w_;}
+
+  explicit operator bool () const;
+
+  friend bool operator == (const Polynomial& lhs, const Polynomial& rhs);
+  friend bool operator != (const Polynomial& lhs, const Polynomial& rhs);
+  friend bool operator < (const Polynomial& lhs, const Polynomial& rhs);
+  friend bool operator > (const Polynomial& lhs, const Polynomial& rhs);
+  friend bool operator <= (const Polynomial& lhs, const Polynomial& rhs);
+  friend bool operator >= (const Polynomial& lhs, const Polynomial& rhs);
+  Polynomial& operator ^= (const Polynomial& rhs);
+  Polynomial& operator |= (const Polynomial& rhs);
+  Polynomial& operator &= (const Polynomial& rhs);
+  Polynomial& operator += (const Polynomial& rhs);
+  Polynomial& operator -= (const Polynomial& rhs);
+  Polynomial& operator *= (const Polynomial& rhs);
+  Polynomial& operator %= (const Polynomial& rhs);
+  Polynomial& operator <<= (int_type n);
+  Polynomial& operator >>= (int_type n);
+
+  friend Polynomial operator ^ (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator | (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator & (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator + (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator - (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator * (const Polynomial& lhs, const Polynomial& rhs);
+  friend Polynomial operator % (const Polynomial& lhs, const Polynomial& rhs);
+  Polynomial operator << (int_type n) const;
+  Polynomial operator >> (int_type n) const;
+
+  friend std::ostream& operator << (std::ostream& os, const Polynomial& obj);
+
+  /**
+   * @brief Indicates whether it is a zero polynomial.
+   */
+  [[nodiscard]] bool empty () const;
+
+  /**
+   * @brief Returns the degree of the polynomial.
+   */
+  [[nodiscard]] int_type degree () const;
+
+  /**
+   * @brief Returns the number of non-zero coefficients.
+   */
+  [[nodiscard]] int_type nnz () const;
+
+  /**
+   * @brief Given an interger n, return whether this polynomial contains an
+   *    x^n term.
+   * @param n
+   */
+  [[nodiscard]] bool contains (int_type n) const;
+
+protected:
+  explicit Polynomial (container_type&& w);
+
+  friend Polynomial detail::multiply (const Polynomial& a,
+                                      const Polynomial& b,
+                                      detail::multiplication method);
+  friend Polynomial detail::remainder (const Polynomial& a,
+                                       const Polynomial& m,
+                                       detail::reduction method);
+
+private:
+  void set (int_type n);
+  void trim ();
+
+  container_type w_; // `w_` for words
+};
+
+}
+
+namespace satz {
+
+template <>
+const gf2::v3::Polynomial zero<gf2::v3::Polynomial> = gf2::v3::Polynomial{};
+
+template <>
+const gf2::v3::Polynomial one<gf2::v3::Polynomial> = gf2::v3::Polynomial{0};
+
+template <>
+const gf2::v3::Polynomial X<gf2::v3::Polynomial> = gf2::v3::Polynomial{1};
+
+}
@@ -0,0 +1,229 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "family.h"
+#include "cpu.h"
+#include "irreducible.h"
+
+#include <algorithm>
+#include <new>
+#include <random>
+#include <unordered_set>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace satz::rabin {
+
+namespace {
+
+// Members are processed in groups of this size by the 512-bit kernel,
+// which the Barrett constants are padded to.
+constexpr size_t sketch_group = 16;
+
+// Draws `k` distinct irreducible polynomials of degree 64, each from a seed
+// drawn from `engine`.
+std::vector<Fingerprint> draw_polynomials (size_t k, std::mt19937_64& engine) {
+  Expects(k > 0);
+
+  std::vector<Fingerprint>        ret;
+  std::unordered_set<Fingerprint> seen;
+  ret.reserve(k);
+  while (ret.size() < k) {
+    auto m = Fingerprint(gf2::native::make_irreducible(64, engine()));
+    if (seen.insert(m).second) ret.push_back(m);
+  }
+  return ret;
+}
+
+void sketch_tables (const GeneratorFamily& family,
+                    gsl::span<const uint64_t> shingles,
+                    gsl::span<Fingerprint> sketch) {
+  for (size_t g = 0; g < family.size(); ++g) {
+    const Fingerprint* t   = family[g].tables().data();
+    Fingerprint        min = ~Fingerprint(0);
+    for (uint64_t s : shingles) {
+      const Fingerprint h = t[0 * 256 + (s & 0xff)]
+                            ^ t[1 * 256 + (s >> 8 & 0xff)]
+                            ^ t[2 * 256 + (s >> 16 & 0xff)]
+                            ^ t[3 * 256 + (s >> 24 & 0xff)]
+                            ^ t[4 * 256 + (s >> 32 & 0xff)]
+                            ^ t[5 * 256 + (s >> 40 & 0xff)]
+                            ^ t[6 * 256 + (s >> 48 & 0xff)]
+                            ^ t[7 * 256 + (s >> 56)];
+      min = std::min(min, h);
+    }
+    sketch[g] = min;
+  }
+}
+
+#if defined(__x86_64__)
+
+// With $h = s \cdot x^{64}$, i.e. a high half `s` and a low half of zero,
+// the Barrett reduction of `detail::fold_clmul` comes down to
+// $q = s + \lfloor s \cdot \mu / x^{64} \rfloor$ and $h mod p = (q \cdot m)
+// mod x^{64}$. Each 128-bit lane of `c` holds $\mu$, then $m$.
+__attribute__((target("pclmul")))
+void sketch_clmul (const GeneratorFamily& family,
+                   gsl::span<const uint64_t> shingles,
+                   gsl::span<Fingerprint> sketch) {
+  const Fingerprint* barrett = family.barrett().data();
+
+  for (size_t g = 0; g < family.size(); g += 4) {
+    __m128i     c[4];
+    Fingerprint min[4];
+    for (size_t j = 0; j < 4; ++j) {
+      c[j] = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(barrett + 2 * (g + j)));
+      min[j] = ~Fingerprint(0);
+    }
+
+    for (uint64_t s : shingles) {
+      const __m128i x = _mm_cvtsi64_si128(int64_t(s));
+      for (size_t j = 0; j < 4; ++j) {
+        __m128i q = _mm_xor_si128(
+            x, _mm_srli_si128(_mm_clmulepi64_si128(x, c[j], 0x00), 8));
+        auto h = Fingerprint(
+            _mm_cvtsi128_si64(_mm_clmulepi64_si128(q, c[j], 0x10)));
+        min[j] = std::min(min[j], h);
+      }
+    }
+
+    for (size_t j = 0; j < 4 && g + j < family.size(); ++j) {
+      sketch[g + j] = min[j];
+    }
+  }
+}
+
+// As `sketch_clmul`, four members per 512-bit vector and sixteen at a time.
+// Only the low half of each lane is meaningful.
+__attribute__((target("avx512f,vpclmulqdq")))
+void sketch_vpclmul (const GeneratorFamily& family,
+                     gsl::span<const uint64_t> shingles,
+                     gsl::span<Fingerprint> sketch) {
+  const Fingerprint* barrett = family.barrett().data();
+
+  for (size_t g = 0; g < family.size(); g += sketch_group) {
+    __m512i c[4], min[4];
+    for (size_t j = 0; j < 4; ++j) {
+      c[j]   = _mm512_loadu_si512(barrett + 2 * (g + 4 * j));
+      min[j] = _mm512_set1_epi64(-1);
+    }
+
+    // The zero-masked forms with every lane selected, rather than the
+    // plain ones, whose undefined pass-through operand GCC reports as
+    // maybe uninitialized; both compile to the same instructions.
+    for (uint64_t s : shingles) {
+      const __m512i x = _mm512_set1_epi64(int64_t(s));
+      for (size_t j = 0; j < 4; ++j) {
+        __m512i p = _mm512_clmulepi64_epi128(x, c[j], 0x00);
+        __m512i q = _mm512_xor_si512(
+            x, _mm512_maskz_shuffle_epi32(0xffff, p, _MM_PERM_DCDC));
+        __m512i h = _mm512_clmulepi64_epi128(q, c[j], 0x10);
+        min[j] = _mm512_maskz_min_epu64(0xff, min[j], h);
+      }
+    }
+
+    alignas(64) Fingerprint lanes[8];
+    for (size_t j = 0; j < 4; ++j) {
+      _mm512_store_si512(lanes, min[j]);
+      for (size_t l = 0; l < 4 && g + 4 * j + l < family.size(); ++l) {
+        sketch[g + 4 * j + l] = lanes[2 * l];
+      }
+    }
+  }
+}
+
+#endif
+
+}
+
+GeneratorFamily::GeneratorFamily (size_t k) {
+  std::mt19937_64 engine(std::random_device{}());
+  polynomials_ = draw_polynomials(k, engine);
+  build();
+}
+
+GeneratorFamily::GeneratorFamily (size_t k, uint64_t seed) {
+  std::mt19937_64 engine(seed);
+  polynomials_ = draw_polynomials(k, engine);
+  build();
+}
+
+void GeneratorFamily::build () {
+  const size_t k = polynomials_.size();
+
+  arena_.reset(static_cast<Fingerprint*>(
+      std::aligned_alloc(64, k * stride * sizeof(Fingerprint))));
+  if (!arena_) throw std::bad_alloc();
+
+  const size_t padded = (k + sketch_group - 1) / sketch_group * sketch_group;
+  barrett_.reserve(2 * padded);
+  for (size_t i = 0; i < k; ++i) {
+    Fingerprint* t = arena_.get() + i * stride;
+    Fingerprint* c = t + detail::lookup_rows * 256;
+    std::fill(c, c + 16, 0);
+    detail::build_lookup(polynomials_[i], t);
+    detail::build_clmul_constants(polynomials_[i], t, c);
+    barrett_.push_back(c[8]);
+    barrett_.push_back(polynomials_[i]);
+  }
+  while (barrett_.size() % (2 * sketch_group)) {
+    barrett_.push_back(barrett_[2 * k - 2]);
+    barrett_.push_back(barrett_[2 * k - 1]);
+  }
+}
+
+void minhash_sketch (const GeneratorFamily& family,
+                     gsl::span<const uint64_t> shingles,
+                     gsl::span<Fingerprint> sketch) {
+  using detail::sketch_kernel;
+
+  auto kernel = cpu::has_vpclmul() ? sketch_kernel::vpclmul
+                : cpu::has_pclmul() ? sketch_kernel::clmul
+                                    : sketch_kernel::tables;
+  detail::minhash_sketch(family, shingles, sketch, kernel);
+}
+
+std::vector<Fingerprint> minhash_sketch (const GeneratorFamily& family,
+                                         gsl::span<const uint64_t> shingles) {
+  std::vector<Fingerprint> ret(family.size());
+  minhash_sketch(family, shingles, ret);
+  return ret;
+}
+
+double minhash_resemblance (gsl::span<const Fingerprint> a,
+                            gsl::span<const Fingerprint> b) {
+  Expects(a.size() == b.size() && !a.empty());
+
+  size_t equal = 0;
+  for (size_t i = 0; i < size_t(a.size()); ++i) equal += a[i] == b[i];
+  return double(equal) / double(a.size());
+}
+
+namespace detail {
+
+void minhash_sketch (const GeneratorFamily& family,
+                     gsl::span<const uint64_t> shingles,
+                     gsl::span<Fingerprint> sketch,
+                     sketch_kernel kernel) {
+  Expects(sketch.size() == family.size());
+
+  switch (kernel) {
+#if defined(__x86_64__)
+    case sketch_kernel::vpclmul:
+      return sketch_vpclmul(family, shingles, sketch);
+    case sketch_kernel::clmul:
+      return sketch_clmul(family, shingles, sketch);
+#endif
+    default:
+      return sketch_tables(family, shingles, sketch);
+  }
+}
+
+}
+
+}
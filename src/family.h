@@ -0,0 +1,167 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <gsl/gsl>
+#include "fingerprint.h"
+#include "kernels.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief A family of fingerprint generators of independent random
+ *    polynomials, as needed for resemblance estimation by min-wise hashing
+ *    (Broder, 1997).
+ *
+ *    The tables of all members are packed into one 64-byte-aligned arena
+ *    allocated once, and the polynomials are drawn through the native
+ *    irreducibility test, so a family of a hundred generators is cheap to
+ *    create. Members are views into the family, which must outlive them.
+ */
+class GeneratorFamily {
+public:
+  /**
+   * @brief A member of the family, with the kernels and fingerprints of
+   *    `FingerprintGenerator(polynomial())`.
+   */
+  class Member : public FingerprintKernels<Member, Fingerprint> {
+  public:
+    [[nodiscard]] Fingerprint polynomial () const {return m_;}
+
+    [[nodiscard]] gsl::span<const Fingerprint> tables () const {
+      return {lookup_, detail::lookup_rows * 256};
+    }
+
+  private:
+    friend class GeneratorFamily;
+    friend class FingerprintKernels<Member, Fingerprint>;
+
+    Member (Fingerprint m, const Fingerprint* lookup, const Fingerprint* k)
+        : m_(m), lookup_(lookup), clmul_(k) { }
+
+    Fingerprint modulus () const {return m_;}
+
+    const Fingerprint* lookup () const {return lookup_;}
+
+    const Fingerprint* clmul_constants () const {return clmul_;}
+
+    Fingerprint        m_;
+    const Fingerprint* lookup_;
+    const Fingerprint* clmul_;
+  };
+
+  /**
+   * @brief Creates `k` generators of distinct random polynomials.
+   * @pre k > 0
+   */
+  explicit GeneratorFamily (size_t k);
+
+  /**
+   * @brief Creates `k` generators of distinct polynomials drawn from a
+   *    pseudo-random sequence, the same for the same seed on every platform.
+   * @pre k > 0
+   */
+  GeneratorFamily (size_t k, uint64_t seed);
+
+  [[nodiscard]] size_t size () const {return polynomials_.size();}
+
+  [[nodiscard]] Member operator [] (size_t i) const {
+    const Fingerprint* base = arena_.get() + i * stride;
+    return Member(polynomials_[i], base, base + detail::lookup_rows * 256);
+  }
+
+  /**
+   * @brief Returns the polynomials of the members, in the form taken by
+   *    `FingerprintGenerator`.
+   */
+  [[nodiscard]] gsl::span<const Fingerprint> polynomials () const {
+    return polynomials_;
+  }
+
+  /**
+   * @brief Returns the Barrett constants of the members, for the sketch
+   *    kernels: $\lfloor x^{128} / p \rfloor$ without its $x^{64}$ term,
+   *    then $p$ without its leading bit, for each member in turn, padded
+   *    with copies of the last member to a multiple of 16 members.
+   */
+  [[nodiscard]] gsl::span<const Fingerprint> barrett () const {
+    return barrett_;
+  }
+
+private:
+  // Words per member in the arena: the tables, then the carry-less
+  // multiplication constants padded to a cache line.
+  static constexpr size_t stride = detail::lookup_rows * 256 + 16;
+
+  struct Free {
+    void operator () (Fingerprint* p) const {std::free(p);}
+  };
+
+  void build ();
+
+  std::vector<Fingerprint>            polynomials_;
+  std::unique_ptr<Fingerprint[], Free> arena_;
+  std::vector<Fingerprint>            barrett_;
+};
+
+/**
+ * @brief Computes the min-hash sketch of a set of shingles: for every member
+ *    $g$ of the family, the smallest $h_g(s)$ over the shingles $s$, where
+ *    $h_g(s) = s \cdot x^{64} mod p_g$ is the fingerprint of the eight bytes
+ *    of $s$ under $g$ starting from zero bytes.
+ *
+ *    Shingles are typically the fingerprints of the k-grams of a document,
+ *    from `RollingFingerprint` or `Winnower`. Each $h_g$ is a bijection, so
+ *    the members act as independent random permutations of the shingles,
+ *    and the fraction of positions at which the sketches of two documents
+ *    agree estimates their resemblance.
+ *
+ *    All members are evaluated in one pass over the shingles, with one
+ *    Barrett reduction per member and shingle: four members per instruction
+ *    with 512-bit carry-less multiplication, one with 128-bit, or eight
+ *    table lookups otherwise. The sketch of no shingles is all ones.
+ *
+ * @pre sketch.size() == family.size()
+ */
+void minhash_sketch (const GeneratorFamily& family,
+                     gsl::span<const uint64_t> shingles,
+                     gsl::span<Fingerprint> sketch);
+
+[[nodiscard]] std::vector<Fingerprint> minhash_sketch (
+    const GeneratorFamily& family, gsl::span<const uint64_t> shingles);
+
+/**
+ * @brief Estimates the resemblance of two documents from their min-hash
+ *    sketches: the fraction of positions at which they agree.
+ * @pre a.size() == b.size() > 0
+ */
+[[nodiscard]] double minhash_resemblance (gsl::span<const Fingerprint> a,
+                                          gsl::span<const Fingerprint> b);
+
+namespace detail {
+
+enum class sketch_kernel {
+  tables,  // eight table lookups per member and shingle
+  clmul,   // one 128-bit carry-less multiplication lane per member
+  vpclmul, // four members per 512-bit carry-less multiplication
+};
+
+/**
+ * @brief `minhash_sketch` with the given kernel, for tests and benchmarks.
+ * @pre the processor supports the kernel
+ */
+void minhash_sketch (const GeneratorFamily& family,
+                     gsl::span<const uint64_t> shingles,
+                     gsl::span<Fingerprint> sketch,
+                     sketch_kernel kernel);
+
+}
+
+}
@@ -0,0 +1,117 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "file.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace satz::rabin {
+
+namespace {
+
+// Bytes handed to the kernels at a time from a mapping; the next window is
+// announced to the kernel while the current one is being fingerprinted.
+constexpr size_t map_window = 8 * 1024 * 1024;
+
+// Size and alignment of the blocks read when a file cannot be mapped.
+constexpr size_t read_block = 1024 * 1024;
+constexpr size_t read_align = 4096;
+
+[[noreturn]] void throw_errno (const std::filesystem::path& path,
+                               const char* what) {
+  throw std::system_error(errno, std::generic_category(),
+                          std::string(what) + " " + path.string());
+}
+
+// Closes the descriptor on scope exit.
+struct FileDescriptor {
+  explicit FileDescriptor (int fd) : fd(fd) { }
+  FileDescriptor (const FileDescriptor&) = delete;
+  FileDescriptor& operator = (const FileDescriptor&) = delete;
+  ~FileDescriptor () { if (fd >= 0) ::close(fd); }
+
+  int fd;
+};
+
+Fingerprint fingerprint_mapped (const uint8_t* p, size_t n,
+                                const FingerprintGenerator& fg,
+                                Fingerprint fp) {
+  for (size_t i = 0; i < n; i += map_window) {
+    size_t len = std::min(map_window, n - i);
+    if (i + len < n) {
+      size_t ahead = std::min(map_window, n - i - len);
+      ::madvise(const_cast<uint8_t*>(p + i + len), ahead, MADV_WILLNEED);
+    }
+    fp = fg(fp, p + i, p + i + len);
+  }
+  return fp;
+}
+
+Fingerprint fingerprint_read (int fd,
+                              const std::filesystem::path& path,
+                              const FingerprintGenerator& fg,
+                              Fingerprint fp) {
+  std::unique_ptr<uint8_t, decltype(&std::free)> buffer(
+      static_cast<uint8_t*>(std::aligned_alloc(read_align, read_block)),
+      &std::free);
+  if (!buffer) throw std::bad_alloc();
+
+  // `pread` keeps the offset explicit; descriptors that cannot seek, such
+  // as pipes, fall back to plain `read`.
+  bool     seekable = true;
+  off_t    offset   = 0;
+  uint8_t* p        = buffer.get();
+  while (true) {
+    ssize_t n = seekable ? ::pread(fd, p, read_block, offset)
+                         : ::read(fd, p, read_block);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == ESPIPE && seekable) {
+        seekable = false;
+        continue;
+      }
+      throw_errno(path, "cannot read");
+    }
+    if (n == 0) return fp;
+    fp = fg(fp, p, p + n);
+    offset += n;
+  }
+}
+
+}
+
+Fingerprint fingerprint_file (const std::filesystem::path& path,
+                              const FingerprintGenerator& fg,
+                              Fingerprint fp) {
+  FileDescriptor file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (file.fd < 0) throw_errno(path, "cannot open");
+
+  struct stat st{};
+  if (::fstat(file.fd, &st) < 0) throw_errno(path, "cannot stat");
+
+  // Files of /proc and /sys report a size of 0 and have content all the
+  // same, so those are read.
+  if (S_ISREG(st.st_mode) && st.st_size > 0) {
+    const auto n = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (map != MAP_FAILED) {
+      ::madvise(map, n, MADV_SEQUENTIAL);
+      fp = fingerprint_mapped(static_cast<const uint8_t*>(map), n, fg, fp);
+      ::munmap(map, n);
+      return fp;
+    }
+  }
+
+  return fingerprint_read(file.fd, path, fg, fp);
+}
+
+}
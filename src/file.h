@@ -0,0 +1,29 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Computes the fingerprint of the content of a file, as if it had
+ *    been read into memory and passed to `fg(fp, first, last)`.
+ *
+ *    The file is mapped into memory with a sequential access hint, so that
+ *    the kernels read the page cache directly. Files that cannot be mapped,
+ *    such as pipes or some special files, are read in large page-aligned
+ *    blocks instead.
+ *
+ * @throw std::system_error if the file cannot be opened or read
+ */
+Fingerprint fingerprint_file (const std::filesystem::path& path,
+                              const FingerprintGenerator& fg,
+                              Fingerprint fp);
+
+}
@@ -0,0 +1,860 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+// Micro-benchmarks, reported as one JSON object per line on the standard
+// output, for tracking performance between releases:
+//
+//    {"benchmark":"kernel/one_byte","bytes":4096,"samples":...,
+//     "iterations":...,"min_ns":...,"median_ns":...,"p99_ns":...,
+//     "cycles":...,"instructions":...,"l1d_misses":...,"branch_misses":...,
+//     "ns_per_byte":...,"gb_per_s":...,"cycles_per_byte":...}
+//    {"benchmark":"make_irreducible/v3","degree":128,...,"ns_per_op":...}
+//
+// Times and event counts are per call: `iterations` calls make a sample,
+// the times are the minimum, median and 99th percentile over the samples,
+// and the event counts and per-byte figures are medians. Event counts are
+// null where hardware counters are not available, see `satz::PerfCounters`.
+//
+// The first line describes the run. Numbers are only comparable between
+// runs of the same build type on the same machine; configure with
+// -DCMAKE_BUILD_TYPE=Release.
+//
+// Options:
+//    --filter TEXT     run the benchmarks whose name contains TEXT
+//    --max-size BYTES  largest input of the kernel benchmarks, 1 GiB by
+//                      default
+//    --min-time MS     repeat each benchmark for at least this long, 200 ms
+//                      by default
+//    --min-samples N   and at least this many times, 5 by default
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "batch.h"
+#include "chunker.h"
+#include "cpu.h"
+#include "dense_polynomial.h"
+#include "family.h"
+#include "file.h"
+#include "fingerprint.h"
+#include "index.h"
+#include "irreducible.h"
+#include "measure.h"
+#include "parallel.h"
+#include "polynomial.h"
+#include "reader.h"
+#include "search.h"
+#include "stream.h"
+#include "winnow.h"
+
+#ifndef RABIN_BUILD_TYPE
+#define RABIN_BUILD_TYPE ""
+#endif
+
+namespace {
+
+using namespace satz::rabin;
+using satz::measure;
+
+struct Options {
+  std::string filter;
+  size_t      max_size    = size_t(1) << 30;
+  int64_t     min_time    = 200; // ms
+  uint64_t    min_samples = 5;
+};
+
+// Exposes the kernels selected by tag.
+struct KernelProbe : FingerprintGenerator {
+  explicit KernelProbe (const FingerprintGenerator& fg)
+      : FingerprintGenerator(fg) { }
+
+  using FingerprintGenerator::operator ();
+};
+
+// Keeps the compiler from discarding a result.
+volatile Fingerprint sink;
+
+template <typename F>
+satz::Statistics repeat (const Options& options, F f, uint64_t bytes = 0) {
+  satz::RepeatOptions repeat;
+  repeat.min_time    = std::chrono::milliseconds(options.min_time);
+  repeat.min_samples = options.min_samples;
+  return measure::repeat(f, bytes, repeat);
+}
+
+bool selected (const Options& options, const std::string& name) {
+  return name.find(options.filter) != std::string::npos;
+}
+
+// Writes a JSON number, or null.
+void write (std::ostream& out, std::optional<double> value) {
+  if (value) {
+    out << *value;
+  } else {
+    out << "null";
+  }
+}
+
+// Writes the fields common to all benchmarks, after the name and the
+// parameter.
+void write_statistics (std::ostream& out, const satz::Statistics& s) {
+  out << R"(,"samples":)" << s.samples << R"(,"iterations":)" << s.iterations
+      << R"(,"min_ns":)" << s.min << R"(,"median_ns":)" << s.median
+      << R"(,"p99_ns":)" << s.p99;
+  out << R"(,"cycles":)";
+  write(out, s.counters.cycles);
+  out << R"(,"instructions":)";
+  write(out, s.counters.instructions);
+  out << R"(,"l1d_misses":)";
+  write(out, s.counters.l1d_misses);
+  out << R"(,"branch_misses":)";
+  write(out, s.counters.branch_misses);
+}
+
+void report_bytes (const std::string& name, const satz::Statistics& s) {
+  std::cout << R"({"benchmark":")" << name << R"(","bytes":)" << s.bytes;
+  write_statistics(std::cout, s);
+  std::cout << R"(,"ns_per_byte":)" << s.ns_per_byte()
+            << R"(,"gb_per_s":)" << s.gb_per_s() << R"(,"cycles_per_byte":)";
+  write(std::cout, s.cycles_per_byte());
+  std::cout << "}" << std::endl;
+}
+
+void report_op (const std::string& name,
+                const char* parameter,
+                long long value,
+                const satz::Statistics& s) {
+  std::cout << R"({"benchmark":")" << name << R"(",")" << parameter
+            << R"(":)" << value;
+  write_statistics(std::cout, s);
+  std::cout << R"(,"ns_per_op":)" << s.median << "}" << std::endl;
+}
+
+// `n` random bytes.
+std::vector<uint8_t> random_bytes (size_t n, uint64_t seed = 1) {
+  std::vector<uint8_t> bytes(n);
+  std::mt19937_64      engine(seed);
+  for (auto& b : bytes) b = uint8_t(engine());
+  return bytes;
+}
+
+// Input sizes from 8 bytes up to the maximum, by factors of 8.
+std::vector<size_t> sizes (const Options& options) {
+  std::vector<size_t> ret;
+  for (size_t n = 8; n <= options.max_size; n *= 8) ret.push_back(n);
+  if (ret.empty() || ret.back() != options.max_size) {
+    ret.push_back(options.max_size);
+  }
+  return ret;
+}
+
+void bench_kernels (const Options& options) {
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+  KernelProbe probe(fg);
+
+  // 32-bit words for the four-byte kernel, seen as bytes by the others.
+  std::vector<uint32_t> words((options.max_size + 3) / 4);
+  std::mt19937          engine(1);
+  for (auto& w : words) w = engine();
+  const auto* bytes = reinterpret_cast<const uint8_t*>(words.data());
+
+  auto run = [&] (const std::string& name, auto tag) {
+    if (!selected(options, name)) return;
+    for (size_t n : sizes(options)) {
+      Fingerprint fp = fp0;
+      report_bytes(name, repeat(options, [&] () {
+        fp = probe(fp, bytes, bytes + n, tag);
+      }, n));
+      sink = fp;
+    }
+  };
+  run("kernel/naive_one_byte", FingerprintGenerator::naive_one_byte_tag{});
+  run("kernel/one_byte", FingerprintGenerator::one_byte_tag{});
+  run("kernel/eight_byte", FingerprintGenerator::eight_byte_tag{});
+  run("kernel/sixteen_byte", FingerprintGenerator::sixteen_byte_tag{});
+  if (satz::cpu::has_pclmul()) {
+    run("kernel/clmul", FingerprintGenerator::clmul_tag{});
+  }
+
+  if (selected(options, "kernel/four_byte")) {
+    for (size_t n : sizes(options)) {
+      Fingerprint fp = fp0;
+      report_bytes("kernel/four_byte", repeat(options, [&] () {
+        fp = probe(fp, words.data(), words.data() + n / 4,
+                   FingerprintGenerator::four_byte_tag{});
+      }, n / 4 * 4));
+      sink = fp;
+    }
+  }
+
+  // The kernel picked by the generator for byte ranges.
+  if (selected(options, "kernel/dispatch")) {
+    for (size_t n : sizes(options)) {
+      Fingerprint fp = fp0;
+      report_bytes("kernel/dispatch", repeat(options, [&] () {
+        fp = fg(fp, bytes, bytes + n);
+      }, n));
+      sink = fp;
+    }
+  }
+
+  // One call per 64-bit value.
+  if (selected(options, "scalar/uint64")) {
+    Fingerprint fp = fp0;
+    uint64_t    i  = 0;
+    report_bytes("scalar/uint64", repeat(options, [&] () {
+      fp = fg(fp, i++);
+    }, 8));
+    sink = fp;
+  }
+}
+
+// Ranges of `T` through `operator ()`, against one scalar call per element
+// folded with `std::accumulate`, the generic path. Inputs are capped at
+// 64 MiB, beyond which the per-element calls take too long to repeat.
+template <typename T>
+void bench_elements (const Options& options, const std::string& type) {
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+
+  const size_t   cap = std::min<size_t>(options.max_size, 64 << 20);
+  std::vector<T> values(cap / sizeof(T));
+  std::mt19937   engine(1);
+  auto* bytes = reinterpret_cast<uint8_t*>(values.data());
+  for (size_t i = 0; i < values.size() * sizeof(T); ++i) {
+    bytes[i] = uint8_t(engine());
+  }
+
+  const auto accumulate = "elements/" + type + "/accumulate";
+  const auto range      = "elements/" + type + "/range";
+  for (size_t n : sizes(options)) {
+    if (n > cap) break;
+    const auto first = values.begin();
+    const auto last  = first + ptrdiff_t(n / sizeof(T));
+    if (last == first) continue;
+    Fingerprint fp = fp0;
+    if (selected(options, accumulate)) {
+      auto binop = [&fg] (Fingerprint fp, const T& value) {
+        return fg(fp, value);
+      };
+      report_bytes(accumulate, repeat(options, [&] () {
+        fp = std::accumulate(first, last, fp, binop);
+      }, n / sizeof(T) * sizeof(T)));
+    }
+    if (selected(options, range)) {
+      report_bytes(range, repeat(options, [&] () {
+        fp = fg(fp, first, last);
+      }, n / sizeof(T) * sizeof(T)));
+    }
+    sink = fp;
+  }
+}
+
+// A row of a table of 64-bit keys and 16-bit columns.
+struct Record {
+  uint64_t key;
+  uint16_t columns[4];
+
+  friend auto fingerprint_fields (const Record& r) {
+    return std::tie(r.key, r.columns);
+  }
+};
+
+// Reading a file and hashing it, in turn with one buffer and overlapped
+// with three, next to reading alone and hashing alone. Reads bypass the
+// page cache where the file system allows.
+void bench_reader (const Options& options) {
+  namespace fs = std::filesystem;
+  if (!selected(options, "reader/")) return;
+
+  const size_t n    = std::min(options.max_size, size_t(256) << 20);
+  const auto   path = fs::temp_directory_path() / "fingerprint.bench.reader";
+  std::vector<uint8_t> bytes(n);
+  std::mt19937_64      engine(1);
+  for (auto& b : bytes) b = uint8_t(engine());
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(bytes.data()),
+             std::streamsize(bytes.size()));
+
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+  KernelProbe probe(fg);
+
+  auto read = [&] (size_t buffers, auto hash) {
+    AsyncReader reader(path, {4 << 20, buffers, true});
+    Fingerprint fp = fp0;
+    for (auto b = reader.next(); !b.empty(); b = reader.next()) {
+      fp = hash(fp, b.data(), b.data() + b.size());
+    }
+    sink = fp;
+  };
+  auto run = [&] (const std::string& kernel, auto hash) {
+    if (selected(options, "reader/hash/" + kernel)) {
+      report_bytes("reader/hash/" + kernel, repeat(options, [&] () {
+        sink = hash(fp0, bytes.data(), bytes.data() + n);
+      }, n));
+    }
+    if (selected(options, "reader/serial/" + kernel)) {
+      report_bytes("reader/serial/" + kernel, repeat(options, [&] () {
+        read(1, hash);
+      }, n));
+    }
+    if (selected(options, "reader/overlapped/" + kernel)) {
+      report_bytes("reader/overlapped/" + kernel, repeat(options, [&] () {
+        read(3, hash);
+      }, n));
+    }
+  };
+
+  if (selected(options, "reader/read")) {
+    report_bytes("reader/read", repeat(options, [&] () {
+      read(3, [] (Fingerprint fp, const uint8_t*, const uint8_t*) {
+        return fp;
+      });
+    }, n));
+  }
+  run("dispatch", [&] (Fingerprint fp, const uint8_t* a, const uint8_t* b) {
+    return fg(fp, a, b);
+  });
+  run("one_byte", [&] (Fingerprint fp, const uint8_t* a, const uint8_t* b) {
+    return probe(fp, a, b, FingerprintGenerator::one_byte_tag{});
+  });
+  fs::remove(path);
+}
+
+// Hashing a file of up to 256 MiB through an ifstream loop with a 1 MiB
+// buffer, and through `fingerprint_file`, which maps it. The file is in
+// the page cache: `reader/*` covers reads from the device.
+void bench_file (const Options& options) {
+  namespace fs = std::filesystem;
+  if (!selected(options, "file/")) return;
+
+  const auto bytes =
+      random_bytes(std::min<size_t>(options.max_size, 256 << 20));
+  const auto path = fs::temp_directory_path() / "fingerprint.bench.file";
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(bytes.data()),
+             std::streamsize(bytes.size()));
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+
+  if (selected(options, "file/ifstream")) {
+    std::vector<uint8_t> buffer(1 << 20);
+    report_bytes("file/ifstream", repeat(options, [&] () {
+      std::ifstream in(path, std::ios::binary);
+      Fingerprint   fp = fp0;
+      while (in.read(reinterpret_cast<char*>(buffer.data()),
+                     std::streamsize(buffer.size())) || in.gcount()) {
+        fp = fg(fp, buffer.data(), buffer.data() + in.gcount());
+      }
+      sink = fp;
+    }, bytes.size()));
+  }
+  if (selected(options, "file/mapped")) {
+    report_bytes("file/mapped", repeat(options, [&] () {
+      sink = fingerprint_file(path, fg, fp0);
+    }, bytes.size()));
+  }
+  fs::remove(path);
+}
+
+// Filling a `FingerprintIndex` of up to 4M entries in batches of 4096,
+// then looking every key up, in batches and one at a time, in another
+// order. Times are per pass over all the keys.
+void bench_index (const Options& options) {
+  if (!selected(options, "index/")) return;
+
+  const size_t n     = std::max<size_t>(1, std::min<size_t>(
+      options.max_size / sizeof(Fingerprint), 4 << 20));
+  const size_t batch = 4096;
+  std::vector<Fingerprint> keys(n);
+  std::mt19937_64          engine(19);
+  for (auto& k : keys) k = engine();
+  std::vector<uint64_t> locations(n);
+  std::iota(locations.begin(), locations.end(), 0);
+
+  auto fill = [&] (FingerprintIndex& index) {
+    std::vector<FingerprintIndex::Insertion> out(batch);
+    for (size_t i = 0; i < n; i += batch) {
+      const size_t m = std::min(batch, n - i);
+      index.insert(gsl::span(keys).subspan(i, m),
+                   gsl::span(locations).subspan(i, m),
+                   gsl::span(out).first(m));
+    }
+  };
+
+  if (selected(options, "index/insert")) {
+    report_op("index/insert", "entries", n, repeat(options, [&] () {
+      FingerprintIndex index(n);
+      fill(index);
+      sink = index.size();
+    }));
+  }
+
+  FingerprintIndex index(n);
+  fill(index);
+  std::shuffle(keys.begin(), keys.end(), engine);
+
+  if (selected(options, "index/find_batched")) {
+    std::vector<std::optional<FingerprintIndex::Entry>> found(batch);
+    report_op("index/find_batched", "entries", n, repeat(options, [&] () {
+      size_t hits = 0;
+      for (size_t i = 0; i < n; i += batch) {
+        const size_t m = std::min(batch, n - i);
+        index.find(gsl::span(keys).subspan(i, m), gsl::span(found).first(m));
+        for (size_t j = 0; j < m; ++j) hits += bool(found[j]);
+      }
+      sink = hits;
+    }));
+  }
+  if (selected(options, "index/find")) {
+    report_op("index/find", "entries", n, repeat(options, [&] () {
+      size_t hits = 0;
+      for (auto k : keys) hits += bool(index.find(k));
+      sink = hits;
+    }));
+  }
+}
+
+void bench_construction (const Options& options) {
+  if (selected(options, "construction/create")) {
+    report_op("construction/create", "degree", 64, repeat(options, [] () {
+      sink = FingerprintGenerator::create().first.polynomial();
+    }));
+  }
+
+  // Tables only: the polynomial is known and no other generator holds its
+  // tables.
+  if (selected(options, "construction/tables")) {
+    const auto m = FingerprintGenerator::create(1).first.polynomial();
+    report_op("construction/tables", "degree", 64, repeat(options, [m] () {
+      sink = FingerprintGenerator(m).tables()[1];
+    }));
+  }
+
+  // A copy shares the tables of the original.
+  if (selected(options, "construction/copy")) {
+    const auto fg = FingerprintGenerator::create(1).first;
+    report_op("construction/copy", "degree", 64, repeat(options, [&] () {
+      FingerprintGenerator copy = fg;
+      sink = copy.polynomial();
+    }));
+  }
+}
+
+// `parallel_fingerprint` on up to 64 MiB, from one thread to as many as
+// the machine has, by factors of 2.
+void bench_parallel (const Options& options) {
+  if (!selected(options, "parallel/")) return;
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+  const auto bytes =
+      random_bytes(std::min<size_t>(options.max_size, 64 << 20));
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= cores; threads *= 2) {
+    const auto name = "parallel/" + std::to_string(threads);
+    if (!selected(options, name)) continue;
+    report_bytes(name, repeat(options, [&] () {
+      sink = parallel_fingerprint(fg, fp0, bytes, threads);
+    }, bytes.size()));
+  }
+}
+
+// Fields of 1 to 16 bytes, as fed by a protocol parser, through one
+// generator call each and through a `FingerprintStream`.
+void bench_stream (const Options& options) {
+  if (!selected(options, "stream/")) return;
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+  const auto bytes =
+      random_bytes(std::min<size_t>(options.max_size, 16 << 20));
+
+  std::vector<size_t> fields;
+  std::mt19937_64     engine(1);
+  for (size_t n = 0; n < bytes.size(); n += fields.back()) {
+    fields.push_back(std::min<size_t>(bytes.size() - n, engine() % 16 + 1));
+  }
+
+  if (selected(options, "stream/generator")) {
+    report_bytes("stream/generator", repeat(options, [&] () {
+      Fingerprint    fp = fp0;
+      const uint8_t* p  = bytes.data();
+      for (auto n : fields) {
+        fp = fg(fp, p, p + n);
+        p += n;
+      }
+      sink = fp;
+    }, bytes.size()));
+  }
+  if (selected(options, "stream/stream")) {
+    report_bytes("stream/stream", repeat(options, [&] () {
+      FingerprintStream stream(fg, fp0);
+      const uint8_t*    p = bytes.data();
+      for (auto n : fields) {
+        stream.update(gsl::span<const uint8_t>(p, n));
+        p += n;
+      }
+      sink = stream.digest();
+    }, bytes.size()));
+  }
+}
+
+// `fingerprint_many` on 16 MiB of records of a given size, or of sizes
+// drawn from 32 to 512 bytes, with each kernel the processor supports and
+// with one generator call per record.
+void bench_batch (const Options& options) {
+  using detail::batch_kernel;
+  if (!selected(options, "batch/")) return;
+  auto [fg, fp0] = FingerprintGenerator::create(1);
+  const auto arena =
+      random_bytes(std::min<size_t>(options.max_size, 16 << 20));
+
+  std::vector<std::pair<const char*, batch_kernel>> kernels = {
+      {"scalar", batch_kernel::scalar}};
+  if (satz::cpu::has_pclmul()) {
+    kernels.emplace_back("clmul", batch_kernel::clmul);
+  }
+
+  for (size_t size : {32, 64, 128, 256, 512, 0}) {
+    std::vector<gsl::span<const uint8_t>> records;
+    std::mt19937_64 engine(5);
+    for (size_t off = 0;;) {
+      const size_t n = size ? size : 32 + engine() % 481;
+      if (off + n > arena.size()) break;
+      records.emplace_back(arena.data() + off, n);
+      off += n;
+    }
+    if (records.empty()) continue;
+    const uint64_t bytes = records.back().data() + records.back().size()
+                           - arena.data();
+    std::vector<Fingerprint> out(records.size());
+
+    const auto prefix =
+        "batch/" + (size ? std::to_string(size) : std::string("32-512")) + "/";
+    if (selected(options, prefix + "loop")) {
+      report_bytes(prefix + "loop", repeat(options, [&] () {
+        for (size_t i = 0; i < records.size(); ++i) {
+          out[i] = fg(fp0, records[i].begin(), records[i].end());
+        }
+      }, bytes));
+    }
+    for (auto [name, kernel] : kernels) {
+      if (!selected(options, prefix + name)) continue;
+      report_bytes(prefix + name, repeat(options, [&] () {
+        detail::fingerprint_many(fg, fp0, records, out, kernel);
+      }, bytes));
+    }
+    sink = out.back();
+  }
+}
+
+// A family of 128 generators, built member by member and at once, and the
+// min-hash sketch of 10000 shingles with each kernel the processor
+// supports.
+void bench_family (const Options& options) {
+  using detail::sketch_kernel;
+  if (!selected(options, "family/")) return;
+  const size_t k = 128;
+
+  if (selected(options, "family/create/separate")) {
+    report_op("family/create/separate", "members", k, repeat(options, [&] () {
+      for (size_t i = 0; i < k; ++i) {
+        sink = FingerprintGenerator::create(i).first.polynomial();
+      }
+    }));
+  }
+  if (selected(options, "family/create/family")) {
+    report_op("family/create/family", "members", k, repeat(options, [&] () {
+      sink = GeneratorFamily(k, 0).size();
+    }));
+  }
+
+  GeneratorFamily       family(k, 0);
+  std::vector<uint64_t> shingles(10000);
+  std::mt19937_64       engine(5);
+  for (auto& s : shingles) s = engine();
+  std::vector<Fingerprint> sketch(k);
+
+  std::vector<std::pair<const char*, sketch_kernel>> kernels = {
+      {"tables", sketch_kernel::tables}};
+  if (satz::cpu::has_pclmul()) {
+    kernels.emplace_back("clmul", sketch_kernel::clmul);
+  }
+  if (satz::cpu::has_vpclmul()) {
+    kernels.emplace_back("vpclmul", sketch_kernel::vpclmul);
+  }
+  for (auto [name, kernel] : kernels) {
+    const auto benchmark = std::string("family/sketch/") + name;
+    if (!selected(options, benchmark)) continue;
+    report_op(benchmark, "members", k, repeat(options, [&] () {
+      detail::minhash_sketch(family, shingles, sketch, kernel);
+      sink = sketch[0];
+    }));
+  }
+}
+
+// A `PatternMatcher` over 256 KiB, with 10 to 1000 signatures of 8 to 40
+// bytes, half of them taken from the haystack, against `std::search` for
+// each signature.
+void bench_search (const Options& options) {
+  if (!selected(options, "search/")) return;
+  const auto fg       = FingerprintGenerator::create(1).first;
+  const auto haystack = random_bytes(std::min<size_t>(options.max_size,
+                                                      256 << 10));
+
+  for (size_t count : {10, 100, 1000}) {
+    std::mt19937_64 engine(29);
+    std::vector<std::vector<uint8_t>> patterns;
+    for (size_t i = 0; i < count; ++i) {
+      const size_t n = std::min<size_t>(8 + engine() % 33, haystack.size());
+      if (i % 2) {
+        const size_t at = engine() % (haystack.size() - n + 1);
+        patterns.emplace_back(haystack.begin() + at, haystack.begin() + at + n);
+      } else {
+        patterns.push_back(random_bytes(n, engine()));
+      }
+    }
+    const std::vector<gsl::span<const uint8_t>> views(patterns.begin(),
+                                                      patterns.end());
+    const PatternMatcher matcher(fg, views);
+
+    const auto suffix = "/" + std::to_string(count);
+    if (selected(options, "search/matcher" + suffix)) {
+      report_bytes("search/matcher" + suffix, repeat(options, [&] () {
+        sink = matcher.find(haystack).size();
+      }, haystack.size()));
+    }
+    if (selected(options, "search/std_search" + suffix)) {
+      report_bytes("search/std_search" + suffix, repeat(options, [&] () {
+        size_t found = 0;
+        for (const auto& p : patterns) {
+          for (auto it = haystack.begin();; ++it) {
+            it = std::search(it, haystack.end(), p.begin(), p.end());
+            if (it == haystack.end()) break;
+            ++found;
+          }
+        }
+        sink = found;
+      }, haystack.size()));
+    }
+  }
+}
+
+// Winnowing documents of 4 KiB, with the selections and signature buffers
+// reused from one document to the next.
+void bench_winnow (const Options& options) {
+  if (!selected(options, "winnow/document")) return;
+  Winnower     winnower(FingerprintGenerator::create(1).first);
+  const size_t doc_size = 4096;
+  const auto   corpus   = random_bytes(
+      std::max(doc_size, std::min<size_t>(options.max_size, 4 << 20)));
+  const size_t docs     = corpus.size() / doc_size;
+
+  std::vector<Selection>   selections;
+  std::vector<Fingerprint> sig;
+  report_bytes("winnow/document", repeat(options, [&] () {
+    for (size_t d = 0; d < docs; ++d) {
+      selections.clear();
+      winnower.select(gsl::span(corpus).subspan(d * doc_size, doc_size),
+                      selections);
+      signature(selections, sig);
+    }
+    sink = sig.size();
+  }, docs * doc_size));
+}
+
+// Content-defined chunking of up to 64 MiB with the default configuration.
+void bench_chunker (const Options& options) {
+  if (!selected(options, "chunker/cut_points")) return;
+  const Chunker chunker(FingerprintGenerator::create(1).first);
+  const auto    corpus = random_bytes(std::min<size_t>(options.max_size,
+                                                       64 << 20));
+  std::vector<size_t> cuts;
+  report_bytes("chunker/cut_points", repeat(options, [&] () {
+    cuts.clear();
+    chunker.cut_points(corpus, std::back_inserter(cuts));
+    sink = cuts.size();
+  }, corpus.size()));
+}
+
+void bench_irreducible (const Options& options) {
+  if (selected(options, "make_irreducible/native")) {
+    for (int degree : {8, 16, 32, 64}) {
+      report_op("make_irreducible/native", "degree", degree,
+                repeat(options, [degree] () {
+                  sink = Fingerprint(
+                      satz::gf2::native::make_irreducible(degree));
+                }));
+    }
+  }
+  if (selected(options, "make_irreducible/v3")) {
+    for (int degree : {64, 128, 256, 512}) {
+      report_op("make_irreducible/v3", "degree", degree,
+                repeat(options, [degree] () {
+                  sink = satz::gf2::v3::Polynomial::make_irreducible(degree)
+                             .words()[0];
+                }));
+    }
+  }
+  // The seeded search on 1, 2, 4... threads and one per core, over a fresh
+  // seed per call.
+  if (selected(options, "make_irreducible/parallel")) {
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < cores; n *= 2) counts.push_back(n);
+    counts.push_back(cores);
+    for (unsigned threads : counts) {
+      const auto benchmark = "make_irreducible/parallel/"
+                             + std::to_string(threads);
+      for (int degree : {64, 128, 256}) {
+        uint64_t seed = 0;
+        report_op(benchmark, "degree", degree,
+                  repeat(options, [degree, threads, &seed] () {
+                    sink = satz::gf2::v3::Polynomial::make_irreducible(
+                        degree, seed++, threads).words()[0];
+                  }));
+      }
+    }
+  }
+  if (selected(options, "make_irreducible/v2")) {
+    for (int degree : {64, 128}) {
+      report_op("make_irreducible/v2", "degree", degree,
+                repeat(options, [degree] () {
+                  sink = satz::gf2::v2::Polynomial::make_irreducible(degree)
+                             .degree();
+                }));
+    }
+  }
+}
+
+template <typename Poly>
+void bench_arithmetic (const Options& options, const std::string& version) {
+  for (int degree : {64, 256, 1024, 4096}) {
+    auto a = Poly::make_random(degree);
+    auto b = Poly::make_random(degree);
+    auto p = Poly::make_random(degree);
+    auto c = a * b;
+
+    if (selected(options, "polynomial/" + version + "/multiply")) {
+      report_op("polynomial/" + version + "/multiply", "degree", degree,
+                repeat(options, [&] () { sink = (a * b).degree(); }));
+    }
+    if (selected(options, "polynomial/" + version + "/modulo")) {
+      report_op("polynomial/" + version + "/modulo", "degree", degree,
+                repeat(options, [&] () { sink = (c % p).degree(); }));
+    }
+  }
+}
+
+// The methods behind v3 multiplication and reduction, on either side of
+// the thresholds `operator *` and `operator %` switch at. Dividends are
+// products, of twice the degree of the divisor.
+void bench_methods (const Options& options) {
+  using Poly = satz::gf2::v3::Polynomial;
+  namespace detail = satz::gf2::v3::detail;
+  using detail::multiplication;
+  using detail::reduction;
+
+  const std::pair<const char*, multiplication> multiplications[] = {
+      {"schoolbook", multiplication::schoolbook},
+      {"karatsuba", multiplication::karatsuba}};
+  const std::pair<const char*, reduction> reductions[] = {
+      {"bitwise", reduction::bitwise},
+      {"barrett", reduction::barrett}};
+
+  for (int degree : {64, 128, 256, 512, 1024, 2048, 4096, 16384}) {
+    auto a = Poly::make_random(degree);
+    auto b = Poly::make_random(degree);
+    auto p = Poly::make_random(degree);
+    auto c = a * b;
+
+    for (auto [name, method] : multiplications) {
+      const auto benchmark = std::string("polynomial/v3/multiply/") + name;
+      if (!selected(options, benchmark)) continue;
+      report_op(benchmark, "degree", degree, repeat(options, [&] () {
+        sink = detail::multiply(a, b, method).degree();
+      }));
+    }
+    for (auto [name, method] : reductions) {
+      const auto benchmark = std::string("polynomial/v3/modulo/") + name;
+      if (!selected(options, benchmark)) continue;
+      report_op(benchmark, "degree", degree, repeat(options, [&] () {
+        sink = detail::remainder(c, p, method).degree();
+      }));
+    }
+  }
+}
+
+Options parse (int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    auto value = [&] () -> const char* {
+      if (i + 1 == argc) {
+        std::cerr << "missing value for " << argv[i] << "\n";
+        std::exit(2);
+      }
+      return argv[++i];
+    };
+    if (!std::strcmp(argv[i], "--filter")) {
+      options.filter = value();
+    } else if (!std::strcmp(argv[i], "--max-size")) {
+      options.max_size = std::max<size_t>(8, std::stoull(value()));
+    } else if (!std::strcmp(argv[i], "--min-time")) {
+      options.min_time = std::stoll(value());
+    } else if (!std::strcmp(argv[i], "--min-samples")) {
+      options.min_samples = std::max<uint64_t>(1, std::stoull(value()));
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--filter TEXT] "
+                << "[--max-size BYTES] [--min-time MS] [--min-samples N]\n";
+      std::exit(2);
+    }
+  }
+  return options;
+}
+
+}
+
+int main (int argc, char** argv) {
+  auto options = parse(argc, argv);
+
+  std::cout << R"({"context":{"build_type":")" << RABIN_BUILD_TYPE
+            << R"(","compiler":")" << __VERSION__
+            << R"(","pclmul":)" << satz::cpu::has_pclmul()
+            << R"(,"avx512":)" << satz::cpu::has_avx512()
+            << R"(,"perf_counters":)" << satz::PerfCounters().available()
+            << R"(,"max_size":)" << options.max_size
+            << R"(,"min_time_ms":)" << options.min_time
+            << R"(,"min_samples":)" << options.min_samples << "}}"
+            << std::endl;
+
+  bench_kernels(options);
+  bench_elements<uint16_t>(options, "uint16");
+  bench_elements<uint32_t>(options, "uint32");
+  bench_elements<uint64_t>(options, "uint64");
+  bench_elements<unsigned __int128>(options, "uint128");
+  bench_elements<Record>(options, "record");
+  bench_reader(options);
+  bench_file(options);
+  bench_index(options);
+  bench_construction(options);
+  bench_parallel(options);
+  bench_stream(options);
+  bench_batch(options);
+  bench_family(options);
+  bench_search(options);
+  bench_winnow(options);
+  bench_chunker(options);
+  bench_irreducible(options);
+  bench_arithmetic<satz::gf2::v2::Polynomial>(options, "v2");
+  bench_arithmetic<satz::gf2::v3::Polynomial>(options, "v3");
+  bench_methods(options);
+  return 0;
+}
@@ -4,64 +4,248 @@
 //
 
 #include "fingerprint.h"
-#include "polynomial.h"
+#include "bytes.h"
+#include "dense_polynomial.h"
+#include "irreducible.h"
 
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 namespace satz::rabin {
 
-FingerprintGenerator::FingerprintGenerator
-    (FingerprintGenerator::value_type m) : m_(m) {
+template <typename Word>
+BasicFingerprintGenerator<Word>::BasicFingerprintGenerator (value_type m)
+    : m_(m) {
 
-  if (!m_) return;
+  if (m_) tables_ = shared_tables(m_);
+}
+
+template <typename Word>
+Word BasicFingerprintGenerator<Word>::combine (
+    value_type fp_left, value_type fp_right, uint64_t len_right) const {
+  return mul_mod(fp_left, shift_factor(len_right)) ^ fp_right;
+}
+
+template <typename Word>
+Word BasicFingerprintGenerator<Word>::mul_mod (
+    value_type a, value_type b) const {
+
+  // Horner's rule over the bits of `b`, most significant first.
+  constexpr int shifts = sizeof(value_type) * 8 - 1;
+  value_type    acc    = 0;
+  for (int i = shifts; i >= 0; --i) {
+    auto msb = bool(acc >> shifts);
+    acc = value_type(acc << 1);
+    if (msb) acc ^= m_;
+    if ((b >> i) & 0x1) acc ^= a;
+  }
+  return acc;
+}
+
+template <typename Word>
+Word BasicFingerprintGenerator<Word>::shift_factor (uint64_t n) const {
+
+  // Same square-and-multiply as `mod_pow`, with base $x^8$.
+  value_type b   = value_type(1) << 8;
+  value_type acc = 1;
+  while (n) {
+    if (n % 2) acc = mul_mod(acc, b);
+    b = mul_mod(b, b);
+    n = n / 2;
+  }
+  return acc;
+}
+
+namespace {
+
+// Drops the leading bit of an irreducible polynomial of degree
+// `sizeof(Word)*8`.
+template <typename Word>
+Word low_terms (const gf2::v3::Polynomial& p) {
+  const auto& w = p.words();
+  Word m = 0;
+  for (size_t i = 0; i < sizeof(Word) / 8; ++i) m |= Word(w[i]) << (64 * i);
+  return m;
+}
+
+// Degrees up to 64 go through the native test, which is much faster and
+// fixes the seeded generators of those widths. Wider ones take long enough
+// to find that the search is spread over the cores, from a random seed if
+// none is given.
+template <typename Word, typename... Seed>
+Word make_modulus (Seed... seed) {
+  constexpr int degree = sizeof(Word) * 8;
+  if constexpr (degree <= 64) {
+    return Word(gf2::native::make_irreducible(degree, seed...));
+  } else if constexpr (sizeof...(Seed) == 0) {
+    return make_modulus<Word>(
+        bytes::from_bytes<uint64_t>(bytes::make_random_bytes(8)));
+  } else {
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    return low_terms<Word>(
+        gf2::v3::Polynomial::make_irreducible(degree, seed..., threads));
+  }
+}
+
+}
+
+template <typename Word>
+auto BasicFingerprintGenerator<Word>::create ()
+    -> std::pair<BasicFingerprintGenerator, value_type> {
+  return {BasicFingerprintGenerator(make_modulus<value_type>()),
+          ~value_type(0)};
+}
+
+template <typename Word>
+auto BasicFingerprintGenerator<Word>::create (uint64_t seed)
+    -> std::pair<BasicFingerprintGenerator, value_type> {
+  return {BasicFingerprintGenerator(make_modulus<value_type>(seed)),
+          ~value_type(0)};
+}
+
+namespace {
+
+// Layout of a serialized generator; all integers are little-endian.
+//
+//    offset  size  field
+//         0     4  magic "RBFP"
+//         4     2  format version
+//         6     2  flags, 0
+//         8     2  fingerprint width in bits
+//        10     2  reserved, 0
+//        12     4  reserved, 0
+//        16     8  polynomial, without its leading bit
+//        24     8  reserved, 0
+//        32     8  bits 64 to 127 of the polynomial, or 0
+//        40    24  reserved, 0
+constexpr uint8_t  serial_magic[4] = {'R', 'B', 'F', 'P'};
+constexpr uint16_t serial_version  = 1;
+constexpr size_t   serial_header   = 64;
+
+template <typename T>
+void put_le (uint8_t* p, T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) p[i] = uint8_t(value >> (8 * i));
+}
 
-  lookup_a_.assign(256, 0);
-  lookup_b_.assign(256, 0);
-  lookup_c_.assign(256, 0);
-  lookup_d_.assign(256, 0);
+template <typename T>
+T get_le (const uint8_t* p) {
+  T value = 0;
+  for (size_t i = sizeof(T); i-- > 0;) value = T(value << 8) | p[i];
+  return value;
+}
 
-  using satz::gf2::Polynomial;
+}
 
-  // restore the irreducible polynomial
-  auto poly_m = Polynomial::from_ulong(m_);
-  auto leading = one<Polynomial> << (sizeof(m_) * 8);
-  const auto p = leading + poly_m;
+namespace {
+
+// The tables held by at least one generator, by polynomial. An entry is
+// removed by the deleter of its tables, unless it was replaced in the
+// meantime.
+template <typename Word>
+struct TableRegistry {
+  using Tables = detail::GeneratorTables<Word>;
+
+  std::mutex mutex;
+  std::map<Word, std::pair<std::weak_ptr<const Tables>, const Tables*>> tables;
+};
+
+template <typename Word>
+TableRegistry<Word>& registry () {
+  // Never destroyed, since generators with static storage duration may
+  // release their tables after it would have been.
+  static auto* r = new TableRegistry<Word>;
+  return *r;
+}
 
-  // precompute the lookup tables
-  for (unsigned int i = 0; i < 256; ++i) {
-    auto a = Polynomial::from_ulong(i) << 88;
-    lookup_a_[i] = bytes::from_bytes<value_type>((a % p).to_bytes());
+}
+
+template <typename Word>
+auto BasicFingerprintGenerator<Word>::shared_tables (value_type m)
+    -> std::shared_ptr<const Tables> {
+
+  auto& r = registry<Word>();
+  {
+    std::lock_guard lock(r.mutex);
+    auto it = r.tables.find(m);
+    if (it != r.tables.end()) {
+      if (auto t = it->second.first.lock()) return t;
+    }
   }
 
-  for (unsigned int i = 0; i < 256; ++i) {
-    auto b = Polynomial::from_ulong(i) << 80;
-    lookup_b_[i] = bytes::from_bytes<value_type>((b % p).to_bytes());
+  // Built outside the lock; if another thread registers the same tables
+  // first, these are dropped.
+  auto* t = new Tables{};
+  detail::build_lookup(m, t->lookup.data());
+  if constexpr (sizeof(value_type) == 8) {
+    detail::build_clmul_constants(m, t->lookup.data(), t->clmul.data());
   }
 
-  for (unsigned int i = 0; i < 256; ++i) {
-    auto c = Polynomial::from_ulong(i) << 72;
-    lookup_c_[i] = bytes::from_bytes<value_type>((c % p).to_bytes());
+  std::shared_ptr<const Tables> built(t, [m] (const Tables* t) {
+    auto& r = registry<Word>();
+    {
+      std::lock_guard lock(r.mutex);
+      auto it = r.tables.find(m);
+      if (it != r.tables.end() && it->second.second == t) r.tables.erase(it);
+    }
+    delete t;
+  });
+
+  std::shared_ptr<const Tables> existing;
+  {
+    std::lock_guard lock(r.mutex);
+    auto& entry = r.tables[m];
+    existing = entry.first.lock();
+    if (!existing) entry = {built, t};
   }
+  // `built` may only be released once the lock is, as its deleter takes it.
+  return existing ? existing : built;
+}
 
-  for (unsigned int i = 0; i < 256; ++i) {
-    auto d = Polynomial::from_ulong(i) << 64;
-    lookup_d_[i] = bytes::from_bytes<value_type>((d % p).to_bytes());
+template <typename Word>
+std::vector<uint8_t> BasicFingerprintGenerator<Word>::serialize () const {
+  std::vector<uint8_t> blob(serial_header, 0);
+  std::copy(std::begin(serial_magic), std::end(serial_magic), blob.begin());
+  put_le<uint16_t>(&blob[4], serial_version);
+  put_le<uint16_t>(&blob[8], sizeof(value_type) * 8);
+  put_le<uint64_t>(&blob[16], uint64_t(m_));
+  if constexpr (sizeof(value_type) > 8) {
+    put_le<uint64_t>(&blob[32], uint64_t(m_ >> 64));
   }
+  return blob;
 }
 
-bool operator == (
-    const FingerprintGenerator& lhs,
-    const FingerprintGenerator& rhs) {return lhs.m_ == rhs.m_;}
+template <typename Word>
+BasicFingerprintGenerator<Word> BasicFingerprintGenerator<Word>::deserialize (
+    gsl::span<const uint8_t> blob) {
 
-bool operator != (
-    const FingerprintGenerator& lhs,
-    const FingerprintGenerator& rhs) {return !(rhs == lhs);}
+  const uint8_t* p = blob.data();
+  const size_t   n = blob.size();
 
-std::pair<FingerprintGenerator, Fingerprint> FingerprintGenerator::create () {
-  using satz::gf2::Polynomial;
-  const auto p = Polynomial::make_irreducible(sizeof(value_type) * 8);
-  auto m = satz::bytes::from_bytes<value_type>(p.to_bytes());
-  return {FingerprintGenerator(m), Fingerprint(~0)};
+  if (n != serial_header ||
+      !std::equal(std::begin(serial_magic), std::end(serial_magic), p)) {
+    throw std::runtime_error("not a serialized fingerprint generator");
+  }
+  // Flags are kept for later versions, which this one cannot read.
+  if (get_le<uint16_t>(p + 4) != serial_version ||
+      get_le<uint16_t>(p + 6) != 0) {
+    throw std::runtime_error("unsupported fingerprint generator version");
+  }
+  if (get_le<uint16_t>(p + 8) != sizeof(value_type) * 8) {
+    throw std::runtime_error("fingerprint width mismatch");
+  }
+
+  auto m = value_type(get_le<uint64_t>(p + 16));
+  if constexpr (sizeof(value_type) > 8) {
+    m |= value_type(get_le<uint64_t>(p + 32)) << 64;
+  }
+  return BasicFingerprintGenerator(m);
 }
 
+template class BasicFingerprintGenerator<uint32_t>;
+template class BasicFingerprintGenerator<uint64_t>;
+template class BasicFingerprintGenerator<unsigned __int128>;
+
 }
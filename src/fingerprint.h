@@ -5,18 +5,42 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <vector>
 #include <utility>
 #include <boost/type_index.hpp>
 #include "bytes.h"
+#include "kernels.h"
 
 namespace satz::rabin {
 
-using Fingerprint = uint64_t;
+namespace detail {
 
 /**
+ * @brief The tables of a generator, computed once per polynomial and shared
+ *    by every generator of that polynomial.
+ */
+template <typename Word>
+struct alignas(64) GeneratorTables {
+  // tables filled in by `build_lookup`
+  std::array<Word, lookup_rows * 256> lookup;
+  // constants filled in by `build_clmul_constants`, 64-bit only
+  std::array<Word, 9> clmul;
+};
+
+}
+
+/**
+ * Copies of a generator share its tables, and so do generators created
+ * separately from the same polynomial, so that copying a generator costs a
+ * reference count increment and the tables stay in cache however many
+ * threads hold one.
+ *
+ * @tparam Word the fingerprint type, one of `uint32_t`, `uint64_t` and
+ *    `unsigned __int128`
  *
  * References:
  *      Fingerprinting by random polynomials, Rabin
@@ -24,140 +48,135 @@ using Fingerprint = uint64_t;
  *
  */
 
-class FingerprintGenerator {
+template <typename Word>
+class BasicFingerprintGenerator
+    : public FingerprintKernels<BasicFingerprintGenerator<Word>, Word> {
 public:
-  struct naive_one_byte_tag { };
-  struct one_byte_tag { };
-  struct four_byte_tag { };
+  using value_type = Word;
 
-  using value_type = Fingerprint;
-  static_assert(sizeof(value_type) == 8);
+  BasicFingerprintGenerator () = default;
+  BasicFingerprintGenerator (const BasicFingerprintGenerator&) = default;
+  BasicFingerprintGenerator (BasicFingerprintGenerator&&) = default;
+  BasicFingerprintGenerator& operator = (const BasicFingerprintGenerator&)
+      = default;
+  BasicFingerprintGenerator& operator = (BasicFingerprintGenerator&&)
+      = default;
 
-  FingerprintGenerator () = default;
-  FingerprintGenerator (const FingerprintGenerator&) = default;
-  FingerprintGenerator (FingerprintGenerator&&) = default;
-  FingerprintGenerator& operator = (const FingerprintGenerator&) = default;
-  FingerprintGenerator& operator = (FingerprintGenerator&&) = default;
+  /**
+   * @brief Creates the fingerprint generator of a known polynomial.
+   * @param m the bit representation of an irreducible polynomial of degree
+   *    `sizeof(value_type)*8`, but with the leading bit removed (thus
+   *    fitting into `value_type`)
+   * @pre the polynomial is irreducible; this is not checked.
+   */
+  explicit BasicFingerprintGenerator (value_type m);
 
   /**
    * @brief Creates a fingerprint generator and the initial fingerprint.
    * @return (fingerprint generator, initial fingerprint) pair
    */
-  static std::pair<FingerprintGenerator, Fingerprint> create ();
-
-  friend bool operator == (const FingerprintGenerator& lhs,
-                           const FingerprintGenerator& rhs);
-
-  friend bool operator != (const FingerprintGenerator& lhs,
-                           const FingerprintGenerator& rhs);
-
-  template <typename InputIt>
-  Fingerprint operator () (Fingerprint fp, InputIt first, InputIt last) const {
-    using T = decltype(*first);
-    static_assert(std::is_scalar_v<std::decay_t<T>>);
-
-    if constexpr (sizeof(T) == 4) {
-      return (*this)(fp, first, last, four_byte_tag{});
-    } else if constexpr (sizeof(T) == 1) {
-      return (*this)(fp, first, last, one_byte_tag{});
-    } else {
-      return std::accumulate(first, last, fp, *this);
-    }
-  }
+  static std::pair<BasicFingerprintGenerator, value_type> create ();
 
-  template <typename T>
-  Fingerprint operator () (Fingerprint fp, T value) const {
-    static_assert(std::is_scalar_v<std::decay_t<T>>);
-    if constexpr (sizeof(value) % 4 == 0) {
-      const uint32_t* first = reinterpret_cast<uint32_t*>(&value);
-      return (*this)(fp,
-                     std::make_reverse_iterator(first + sizeof(value) / 4),
-                     std::make_reverse_iterator(first),
-                     four_byte_tag{});
-    } else {
-      const uint8_t* first = reinterpret_cast<uint8_t*>(&value);
-      return (*this)(fp,
-                     std::make_reverse_iterator(first + sizeof(value)),
-                     std::make_reverse_iterator(first),
-                     one_byte_tag{});
-    }
-  }
+  /**
+   * @brief Creates a fingerprint generator and the initial fingerprint
+   *    deterministically, so that fingerprints computed by different
+   *    processes with the same seed are comparable.
+   * @return (fingerprint generator, initial fingerprint) pair
+   */
+  static std::pair<BasicFingerprintGenerator, value_type> create (
+      uint64_t seed);
+
+  /**
+   * @brief Returns the polynomial in the form taken by the constructor.
+   */
+  [[nodiscard]] value_type polynomial () const {return m_;}
 
-protected:
-  template <typename InputIt>
-  Fingerprint operator () (
-      Fingerprint fp, InputIt first, InputIt last, naive_one_byte_tag) const {
-
-    static_assert(sizeof(decltype(*first)) == 1);
-
-    auto binop = [m = m_] (Fingerprint fp, uint8_t b) -> Fingerprint {
-      int i = 8;
-      while (i-- > 0) {
-        constexpr int shifts = sizeof(value_type) * 8 - 1;
-        auto          msb    = bool(fp >> shifts);
-        fp = (fp << 1) | ((b >> i) & 0x1);
-        if (msb) fp = fp ^ m;
-      }
-      return fp;
-    };
-
-    return std::accumulate(first, last, fp, binop);
+  /**
+   * @brief Returns the lookup tables: `detail::lookup_rows` tables of 256
+   *    entries, where entry `b` of table `j` is $b \cdot x^{w+8j} mod p$.
+   */
+  [[nodiscard]] gsl::span<const value_type> tables () const {
+    if (!tables_) return {};
+    return tables_->lookup;
   }
 
-  template <typename InputIt>
-  Fingerprint operator () (
-      Fingerprint fp, InputIt first, InputIt last, one_byte_tag) const {
-    static_assert(sizeof(decltype(*first)) == 1);
-
-    // The derivation of the formula below is similar to the one
-    // used in Broder's paper.
-    auto binop = [this] (Fingerprint fp, uint8_t b) -> Fingerprint {
-      uint8_t* u8fp = reinterpret_cast<uint8_t*>(&fp);
-      return ((fp << 8) | b) ^ lookup_d_[u8fp[7]];
-    };
-    return std::accumulate(first, last, fp, binop);
+  /**
+   * @brief Serializes the generator into a versioned, little-endian binary
+   *    format: a 64-byte header holding the polynomial. The tables are not
+   *    included, since `deserialize` builds them faster than it could
+   *    check and copy them.
+   */
+  [[nodiscard]] std::vector<uint8_t> serialize () const;
+
+  /**
+   * @brief Restores a generator written by `serialize`.
+   * @throw std::runtime_error if the blob is malformed, or has an
+   *    unsupported version, flags or width
+   */
+  static BasicFingerprintGenerator deserialize (gsl::span<const uint8_t> blob);
+
+  friend bool operator == (const BasicFingerprintGenerator& lhs,
+                           const BasicFingerprintGenerator& rhs) {
+    return lhs.m_ == rhs.m_;
   }
 
-  template <typename InputIt>
-  Fingerprint operator () (
-      Fingerprint fp, InputIt first, InputIt last, four_byte_tag) const {
-
-    static_assert(sizeof(decltype(*first)) == 4);
-
-    // We use the optimization technique in Broder's paper:
-    //    Some applications of Rabin's fingerprinting method.
-    // For details read Section 4 of that paper. It brings
-    // us roughly 7~10x speedup for uint64_t, compared to
-    // naive implementation.
-    auto binop = [this] (Fingerprint fp, uint32_t x) -> Fingerprint {
-      auto u32fp = reinterpret_cast<uint32_t*>(&fp);
-      auto u8fp  = reinterpret_cast<uint8_t*>(&u32fp[1]);
-
-      auto u32a = reinterpret_cast<const uint32_t*>(&lookup_a_[u8fp[3]]);
-      auto u32b = reinterpret_cast<const uint32_t*>(&lookup_b_[u8fp[2]]);
-      auto u32c = reinterpret_cast<const uint32_t*>(&lookup_c_[u8fp[1]]);
-      auto u32d = reinterpret_cast<const uint32_t*>(&lookup_d_[u8fp[0]]);
-
-      u32fp[1] = u32fp[0] ^ u32a[1] ^ u32b[1] ^ u32c[1] ^ u32d[1];
-      u32fp[0] = x ^ u32a[0] ^ u32b[0] ^ u32c[0] ^ u32d[0];
-      return fp;
-    };
-    return std::accumulate(first, last, fp, binop);
+  friend bool operator != (const BasicFingerprintGenerator& lhs,
+                           const BasicFingerprintGenerator& rhs) {
+    return !(rhs == lhs);
   }
 
-protected:
-  // `m` is the bit representation of an irreducible polynomial
-  //    of degree `sizeof(value_type)*8` but with the leading bit
-  //    removed (thus fitting into `value_type`)
-  explicit FingerprintGenerator (value_type m);
+  /**
+   * @brief Given the fingerprints of two byte strings, returns the
+   *    fingerprint of their concatenation.
+   * @param fp_left fingerprint of the left string
+   * @param fp_right fingerprint of the right string, starting from zero
+   * @param len_right number of bytes in the right string
+   */
+  value_type combine (value_type fp_left,
+                      value_type fp_right,
+                      uint64_t len_right) const;
 
 private:
-  value_type              m_ = 0;
-  std::vector<value_type> lookup_a_;
-  std::vector<value_type> lookup_b_;
-  std::vector<value_type> lookup_c_;
-  std::vector<value_type> lookup_d_;
+  friend class FingerprintKernels<BasicFingerprintGenerator, Word>;
+
+  using Tables = detail::GeneratorTables<value_type>;
+
+  // Returns the tables of `m`, building them if no generator holds them.
+  static std::shared_ptr<const Tables> shared_tables (value_type m);
+
+  // Returns $(a \cdot b) mod p$.
+  value_type mul_mod (value_type a, value_type b) const;
+
+  // Returns $x^{8n} mod p$, i.e. the factor by which appending `n` bytes
+  // multiplies a fingerprint.
+  value_type shift_factor (uint64_t n) const;
+
+  value_type modulus () const {return m_;}
+
+  const value_type* lookup () const {return tables_->lookup.data();}
+
+  const value_type* clmul_constants () const {return tables_->clmul.data();}
+
+  value_type                    m_ = 0;
+  std::shared_ptr<const Tables> tables_;
 };
 
-}
+extern template class BasicFingerprintGenerator<uint32_t>;
+extern template class BasicFingerprintGenerator<uint64_t>;
+extern template class BasicFingerprintGenerator<unsigned __int128>;
+
+/**
+ * @brief 32-bit fingerprints, for in-memory hash tables where the size of
+ *    an entry matters more than the odds of a collision.
+ */
+using FingerprintGenerator32 = BasicFingerprintGenerator<uint32_t>;
 
+using FingerprintGenerator = BasicFingerprintGenerator<Fingerprint>;
+
+/**
+ * @brief 128-bit fingerprints, for sets too large for 64-bit collision
+ *    odds.
+ */
+using FingerprintGenerator128 = BasicFingerprintGenerator<unsigned __int128>;
+
+}
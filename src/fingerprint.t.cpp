@@ -6,10 +6,40 @@
 //
 
 
-#include <iostream>
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "batch.h"
+#include "chunker.h"
+#include "dense_polynomial.h"
+#include "family.h"
+#include "file.h"
 #include "fingerprint.h"
+#include "index.h"
+#include "irreducible.h"
+#include "rolling.h"
+#include "search.h"
+#include "static_fingerprint.h"
+#include "stream.h"
+#include "winnow.h"
 #include "measure.h"
+#include "parallel.h"
+#include "polynomial.h"
+#include "pool.h"
+#include "reader.h"
+#include "scan.h"
 #include "gtest/gtest.h"
 
 namespace {
@@ -44,30 +74,1253 @@ TEST(Fingerprint, correctness) {
   EXPECT_EQ(fp1, fp3);
 }
 
-TEST(Fingerprint, four_byte_speed) {
+std::vector<uint8_t> make_corpus (size_t n, uint64_t seed = 42) {
+  std::mt19937_64      engine(seed);
+  std::vector<uint8_t> corpus(n);
+  for (auto& b : corpus) b = uint8_t(engine());
+  return corpus;
+}
+
+// Exposes the kernels selected by tag.
+template <typename Word = satz::rabin::Fingerprint>
+struct KernelProbe : satz::rabin::BasicFingerprintGenerator<Word> {
+  explicit KernelProbe (const satz::rabin::BasicFingerprintGenerator<Word>& fg)
+      : satz::rabin::BasicFingerprintGenerator<Word>(fg) { }
+
+  using satz::rabin::BasicFingerprintGenerator<Word>::operator ();
+};
+
+TEST(Fingerprint, slicing_kernels) {
   using namespace satz::rabin;
-  using satz::measure;
 
-  FingerprintGenerator fg;
-  Fingerprint fp = 0;
+  auto [fg, fp] = FingerprintGenerator::create();
+  KernelProbe probe(fg);
+
+  auto bytes = satz::bytes::make_random_bytes(300);
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t n = 0; n + offset <= bytes.size(); n += (n < 40 ? 1 : 37)) {
+      auto first = bytes.data() + offset;
+      auto last  = first + n;
+      auto expected = probe(fp, first, last,
+                            FingerprintGenerator::one_byte_tag{});
+      ASSERT_EQ(probe(fp, first, last, FingerprintGenerator::eight_byte_tag{}),
+                expected) << "offset " << offset << ", length " << n;
+      ASSERT_EQ(probe(fp, first, last,
+                      FingerprintGenerator::sixteen_byte_tag{}),
+                expected) << "offset " << offset << ", length " << n;
+      ASSERT_EQ(fg(fp, first, last), expected)
+                << "offset " << offset << ", length " << n;
+    }
+  }
+
+  std::vector<uint8_t> vec(bytes.begin(), bytes.end());
+  EXPECT_EQ(fg(fp, vec.begin(), vec.end()),
+            probe(fp, vec.begin(), vec.end(),
+                  FingerprintGenerator::naive_one_byte_tag{}));
+}
+
+TEST(Fingerprint, clmul_kernel) {
+  using namespace satz::rabin;
+
+  if (!satz::cpu::has_pclmul()) GTEST_SKIP() << "no PCLMULQDQ support";
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  KernelProbe probe(fg);
+
+  auto bytes = satz::bytes::make_random_bytes(4096);
+  for (size_t n : {0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 200, 1000, 4096}) {
+    auto first = bytes.data();
+    auto last  = bytes.data() + n;
+    EXPECT_EQ(probe(fp, first, last, FingerprintGenerator::clmul_tag{}),
+              probe(fp, first, last, FingerprintGenerator::one_byte_tag{}))
+              << "length " << n;
+    EXPECT_EQ(probe(0, first, last, FingerprintGenerator::clmul_tag{}),
+              probe(0, first, last, FingerprintGenerator::one_byte_tag{}))
+              << "length " << n;
+  }
+
+  // The public operator picks the kernel for long contiguous inputs.
+  EXPECT_EQ(fg(fp, bytes.begin(), bytes.end()),
+            probe(fp, bytes.begin(), bytes.end(),
+                  FingerprintGenerator::one_byte_tag{}));
+}
+
+TEST(Fingerprint, combine) {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  auto bytes = satz::bytes::make_random_bytes(5000);
+
+  auto whole = fg(fp, bytes.begin(), bytes.end());
+  for (size_t cut : {0, 1, 7, 8, 100, 2500, 4999, 5000}) {
+    auto left  = fg(fp, bytes.begin(), bytes.begin() + cut);
+    auto right = fg(Fingerprint(0), bytes.begin() + cut, bytes.end());
+    EXPECT_EQ(fg.combine(left, right, bytes.size() - cut), whole)
+              << "cut " << cut;
+  }
+}
+
+TEST(Fingerprint, parallel) {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+
+  for (size_t n : {0, 1000, (4 << 20) + 3}) {
+    auto bytes    = make_corpus(n);
+    auto expected = fg(fp, bytes.begin(), bytes.end());
+    for (unsigned threads : {1, 2, 3, 7, 16}) {
+      EXPECT_EQ(parallel_fingerprint(fg, fp, bytes, threads), expected)
+                << "length " << n << ", threads " << threads;
+    }
+  }
+}
+
+TEST(Fingerprint, seeded_creation) {
+  using namespace satz::rabin;
+
+  auto [fg1, fp1] = FingerprintGenerator::create(42);
+  auto [fg2, fp2] = FingerprintGenerator::create(42);
+  auto [fg3, fp3] = FingerprintGenerator::create(43);
+
+  EXPECT_EQ(fg1, fg2);
+  EXPECT_NE(fg1, fg3);
+  EXPECT_EQ(fp1, fp2);
+  EXPECT_EQ(FingerprintGenerator(fg1.polynomial()), fg1);
+
+  // Seeded generators must not change between releases.
+  EXPECT_EQ(fg1.polynomial(), 0x5f75917a3eb7b901ULL);
+
+  auto bytes = satz::bytes::make_random_bytes(100);
+  EXPECT_EQ(fg1(fp1, bytes.begin(), bytes.end()),
+            fg2(fp2, bytes.begin(), bytes.end()));
+}
+
+TEST(Fingerprint, static_generator) {
+  using namespace satz::rabin;
+
+  constexpr Fingerprint poly = 0x5f75917a3eb7b901ULL;
+  using Static = StaticFingerprintGenerator<poly>;
+
+  // $x^{64} mod p$ is the polynomial itself, computed by the compiler.
+  static_assert(Static{}.push(Fingerprint(1) << 56, 0) == poly);
+
+  Static               sfg;
+  FingerprintGenerator fg(poly);
+  Fingerprint          fp = ~0;
+
+  for (size_t n : {0, 1, 15, 16, 17, 127, 128, 129, 4096 + 3}) {
+    auto bytes = make_corpus(n);
+    EXPECT_EQ(sfg(fp, bytes.begin(), bytes.end()),
+              fg(fp, bytes.begin(), bytes.end()));
+  }
+
+  std::vector<uint32_t> words{1, 2, 0xdeadbeef, 0xffffffff};
+  EXPECT_EQ(sfg(fp, words.begin(), words.end()),
+            fg(fp, words.begin(), words.end()));
+  EXPECT_EQ(sfg(fp, uint64_t(0x0123456789abcdef)),
+            fg(fp, uint64_t(0x0123456789abcdef)));
+  EXPECT_EQ(sfg(fp, uint8_t(0xa5)), fg(fp, uint8_t(0xa5)));
+}
+
+// Checks every kernel of a generator of the given width against the naive
+// bit-by-bit one, plus the invariants of `combine` and serialization.
+template <typename Word>
+void check_width () {
+  using namespace satz::rabin;
+  using Generator = BasicFingerprintGenerator<Word>;
+  using Probe     = KernelProbe<Word>;
+
+  auto [fg, fp] = Generator::create();
+  Probe probe(fg);
+
+  // $x^w mod p$ is the polynomial itself
+  constexpr int bits = sizeof(Word) * 8;
+  EXPECT_TRUE(fg.push(Word(1) << (bits - 8), 0) == fg.polynomial());
+
+  auto bytes = make_corpus(300);
+  for (size_t n = 0; n <= bytes.size(); n += (n < 40 ? 1 : 37)) {
+    auto first = bytes.data();
+    auto last  = first + n;
+    Word expected = probe(fp, first, last,
+                          typename Generator::naive_one_byte_tag{});
+    ASSERT_TRUE(probe(fp, first, last, typename Generator::one_byte_tag{})
+                == expected) << "length " << n;
+    ASSERT_TRUE(probe(fp, first, last, typename Generator::eight_byte_tag{})
+                == expected) << "length " << n;
+    ASSERT_TRUE(probe(fp, first, last, typename Generator::sixteen_byte_tag{})
+                == expected) << "length " << n;
+    ASSERT_TRUE(fg(fp, first, last) == expected) << "length " << n;
+  }
+
+  // Scalars and 32-bit words are consumed as big-endian bytes.
+  std::array<uint8_t, 8> be = {0xde, 0xad, 0x00, 0x00, 0xfe, 0xed, 0xbe, 0xef};
+  std::array<uint32_t, 2> words = {0xdead0000, 0xfeedbeef};
+  Word expected = fg(fp, be.begin(), be.end());
+  EXPECT_TRUE(fg(fp, 0xdead0000feedbeefULL) == expected);
+  EXPECT_TRUE(fg(fp, words.begin(), words.end()) == expected);
+
+  auto left  = fg(fp, bytes.begin(), bytes.begin() + 100);
+  auto right = fg(Word(0), bytes.begin() + 100, bytes.end());
+  EXPECT_TRUE(fg.combine(left, right, bytes.size() - 100)
+              == fg(fp, bytes.begin(), bytes.end()));
+
+  auto blob = fg.serialize();
+  EXPECT_EQ(Generator::deserialize(blob), fg);
+  EXPECT_TRUE(Generator::deserialize(blob)(fp, bytes.begin(), bytes.end())
+              == fg(fp, bytes.begin(), bytes.end()));
+
+  EXPECT_EQ(Generator::create(7).first, Generator::create(7).first);
+}
+
+TEST(Fingerprint, widths) {
+  check_width<uint32_t>();
+  check_width<uint64_t>();
+  check_width<unsigned __int128>();
+
+  // A blob is only accepted by a generator of its own width.
+  auto blob = satz::rabin::FingerprintGenerator::create().first.serialize();
+  EXPECT_THROW(satz::rabin::FingerprintGenerator32::deserialize(blob),
+               std::runtime_error);
+}
+
+// Checks the range kernels for 2- to 16-byte elements, contiguous or not,
+// against the scalar operator applied element by element.
+template <typename Word, typename T>
+void check_elements () {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = BasicFingerprintGenerator<Word>::create(3);
+  auto bytes = make_corpus(300 * sizeof(T));
+  std::vector<T> values(300);
+  std::memcpy(values.data(), bytes.data(), bytes.size());
+
+  for (size_t n = 0; n <= values.size(); n += (n < 40 ? 1 : 37)) {
+    Word expected = fp;
+    for (size_t i = 0; i < n; ++i) expected = fg(expected, values[i]);
+
+    auto first = values.begin();
+    std::list<T> list(first, first + ptrdiff_t(n));
+    ASSERT_TRUE(fg(fp, first, first + ptrdiff_t(n)) == expected)
+        << sizeof(T) << "-byte elements, length " << n;
+    ASSERT_TRUE(fg(fp, list.begin(), list.end()) == expected)
+        << sizeof(T) << "-byte elements, length " << n;
+  }
+}
+
+// A row of a table, fingerprinted by its fields.
+struct Record {
+  uint64_t key;
+  uint16_t columns[4];
+
+  friend auto fingerprint_fields (const Record& r) {
+    return std::tie(r.key, r.columns);
+  }
+};
+
+TEST(Fingerprint, element_ranges) {
+  using namespace satz::rabin;
+
+  check_elements<uint32_t, uint16_t>();
+  check_elements<uint32_t, uint64_t>();
+  check_elements<uint64_t, int16_t>();
+  check_elements<uint64_t, uint32_t>();
+  check_elements<uint64_t, uint64_t>();
+  check_elements<uint64_t, double>();
+  check_elements<uint64_t, unsigned __int128>();
+  check_elements<unsigned __int128, uint16_t>();
+  check_elements<unsigned __int128, uint64_t>();
+  check_elements<unsigned __int128, unsigned __int128>();
+
+  // Records are consumed field by field.
+  static_assert(detail::is_record_v<Record>);
+  static_assert(!detail::is_record_v<std::array<uint16_t, 4>>);
+  static_assert(!detail::is_record_v<std::pair<uint8_t, uint64_t>>);
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  std::vector<Record> records(50);
+  Fingerprint expected = fp;
+  for (size_t i = 0; i < records.size(); ++i) {
+    records[i] = {0x0123456789abcdef * i, {uint16_t(i), 1, 2, 3}};
+    expected   = fg(expected, records[i].key);
+    expected   = fg(expected, std::begin(records[i].columns),
+                    std::end(records[i].columns));
+  }
+  EXPECT_EQ(fg(fp, records.begin(), records.end()), expected);
+  EXPECT_EQ(fg(fp, records[1]),
+            fg(fg(fp, uint64_t(0x0123456789abcdef)),
+               uint64_t(0x0001000100020003)));
+
+  std::list<Record> list(records.begin(), records.end());
+  EXPECT_EQ(fg(fp, list.begin(), list.end()), expected);
+}
+
+TEST(Fingerprint, shared_tables) {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = FingerprintGenerator::create(3);
+  auto copy     = fg;
+  FingerprintGenerator same(fg.polynomial());
+  auto restored = FingerprintGenerator::deserialize(fg.serialize());
+  EXPECT_EQ(copy.tables().data(), fg.tables().data());
+  EXPECT_EQ(same.tables().data(), fg.tables().data());
+  EXPECT_EQ(restored.tables().data(), fg.tables().data());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(fg.tables().data()) % 64, 0u);
+
+  auto other = FingerprintGenerator::create(4).first;
+  EXPECT_NE(other.tables().data(), fg.tables().data());
+
+  // Tables outlive the generator they were built for, and are built anew
+  // once no generator holds them.
+  auto bytes = make_corpus(1000);
+  auto expected = fg(fp, bytes.begin(), bytes.end());
+  auto m = fg.polynomial();
+  fg = FingerprintGenerator();
+  EXPECT_EQ(copy(fp, bytes.begin(), bytes.end()), expected);
+  copy = same = restored = FingerprintGenerator();
+  EXPECT_EQ(FingerprintGenerator(m)(fp, bytes.begin(), bytes.end()), expected);
+
+  // Generators created at once by many threads share one set of tables.
+  std::vector<FingerprintGenerator> generators(8);
+  std::vector<std::thread>          threads;
+  for (auto& g : generators) {
+    threads.emplace_back([&g, m = other.polynomial()] () {
+      g = FingerprintGenerator(m);
+    });
+  }
+  for (auto& t : threads) t.join();
+  for (auto& g : generators) {
+    EXPECT_EQ(g.tables().data(), other.tables().data());
+  }
+}
+
+TEST(Fingerprint, serialization) {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  auto bytes = satz::bytes::make_random_bytes(1000);
+  auto expected = fg(fp, bytes.begin(), bytes.end());
+
+  auto blob = fg.serialize();
+  EXPECT_EQ(blob.size(), 64u);
+
+  auto copy = FingerprintGenerator::deserialize(blob);
+  EXPECT_EQ(copy, fg);
+  EXPECT_EQ(copy(fp, bytes.begin(), bytes.end()), expected);
+  EXPECT_EQ(copy.serialize(), blob);
+
+  EXPECT_THROW(FingerprintGenerator::deserialize(
+                   gsl::span<const uint8_t>(blob.data(), 63)),
+               std::runtime_error);
+
+  // Flags and trailing bytes are left to later versions.
+  auto flagged = blob;
+  flagged[6] = 0x1;
+  EXPECT_THROW(FingerprintGenerator::deserialize(flagged), std::runtime_error);
+  auto longer = blob;
+  longer.push_back(0);
+  EXPECT_THROW(FingerprintGenerator::deserialize(longer), std::runtime_error);
+
+  auto future = blob;
+  future[4] = 2;
+  EXPECT_THROW(FingerprintGenerator::deserialize(future), std::runtime_error);
+}
+
+TEST(Fingerprint, batch) {
+  using namespace satz::rabin;
+  using detail::batch_kernel;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  auto arena = make_corpus(1024 * 1024);
+
+  // Lengths around the block size and the lane count, plus a few long
+  // records that skip the lanes.
+  std::vector<gsl::span<const uint8_t>> records;
+  std::mt19937_64 engine(3);
+  for (size_t i = 0; i < 2000; ++i) {
+    size_t n = i % 97 == 0 ? 5000 : engine() % 600;
+    records.emplace_back(arena.data() + engine() % (arena.size() - n), n);
+  }
+
+  std::vector<Fingerprint> expected;
+  for (auto r : records) expected.push_back(fg(fp, r.begin(), r.end()));
+
+  std::vector<batch_kernel> kernels = {batch_kernel::scalar};
+  if (satz::cpu::has_pclmul()) kernels.push_back(batch_kernel::clmul);
+
+  for (auto kernel : kernels) {
+    for (size_t n : {size_t(0), size_t(1), size_t(7), records.size()}) {
+      std::vector<Fingerprint> out(n);
+      detail::fingerprint_many(fg, fp, gsl::span(records).first(n), out,
+                               kernel);
+      EXPECT_TRUE(std::equal(out.begin(), out.end(), expected.begin()))
+                << "kernel " << int(kernel) << ", " << n << " records";
+    }
+  }
+
+  std::vector<Fingerprint> out(records.size());
+  fingerprint_many(fg, fp, records, out);
+  EXPECT_EQ(out, expected);
+}
+
+TEST(Fingerprint, file) {
+  using namespace satz::rabin;
+  namespace fs = std::filesystem;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  auto path  = fs::temp_directory_path() / "rabin_fingerprint_file.t";
+  auto bytes = make_corpus(3 * 1024 * 1024 + 17);
+
+  std::ofstream(path, std::ios::binary)
+      .write(reinterpret_cast<const char*>(bytes.data()),
+             std::streamsize(bytes.size()));
+  EXPECT_EQ(fingerprint_file(path, fg, fp),
+            fg(fp, bytes.begin(), bytes.end()));
+
+  std::ofstream(path, std::ios::binary | std::ios::trunc);
+  EXPECT_EQ(fingerprint_file(path, fg, fp), fp);
+
+  // A pipe cannot be mapped and goes through the read loop.
+  fs::remove(path);
+  ASSERT_EQ(::mkfifo(path.c_str(), 0600), 0);
+  std::thread writer([&] () {
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(bytes.data()),
+               std::streamsize(bytes.size()));
+  });
+  EXPECT_EQ(fingerprint_file(path, fg, fp),
+            fg(fp, bytes.begin(), bytes.end()));
+  writer.join();
+  fs::remove(path);
+
+  EXPECT_THROW(fingerprint_file(path, fg, fp), std::system_error);
+
+  // A size of 0 does not mean an empty file under /proc. The status of
+  // this process changes as it allocates the read buffer, so that of an
+  // idle child is read instead, between two identical reads.
+  const pid_t child = ::fork();
+  if (child == 0) {
+    ::pause();
+    ::_exit(0);
+  }
+  ASSERT_GT(child, 0);
+  const auto status = "/proc/" + std::to_string(child) + "/status";
+  ASSERT_EQ(fs::file_size(status), 0u);
+  auto read = [&] () {
+    std::ifstream        in(status, std::ios::binary);
+    std::vector<uint8_t> ret;
+    for (char c; in.get(c);) ret.push_back(uint8_t(c));
+    return ret;
+  };
+  bool compared = false;
+  for (int attempt = 0; attempt < 100 && !compared; ++attempt) {
+    auto before = read();
+    auto actual = fingerprint_file(status, fg, fp);
+    if (read() != before) continue;
+    EXPECT_FALSE(before.empty());
+    EXPECT_EQ(actual, fg(fp, before.begin(), before.end()));
+    compared = true;
+  }
+  ::kill(child, SIGKILL);
+  ::waitpid(child, nullptr, 0);
+  EXPECT_TRUE(compared);
+}
+
+TEST(AsyncReader, reads_whole_file) {
+  using namespace satz::rabin;
+  namespace fs = std::filesystem;
+
+  auto path  = fs::temp_directory_path() / "rabin_async_reader.t";
+  auto bytes = make_corpus(3 * 1024 * 1024 + 17);
+  auto write = [&] (size_t n) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(bytes.data()),
+               std::streamsize(n));
+  };
+  auto read = [&] (ReaderConfig config) {
+    AsyncReader          reader(path, config);
+    std::vector<uint8_t> ret;
+    for (auto b = reader.next(); !b.empty(); b = reader.next()) {
+      EXPECT_LE(size_t(b.size()), config.buffer_size);
+      ret.insert(ret.end(), b.begin(), b.end());
+    }
+    EXPECT_TRUE(reader.next().empty());
+    return ret;
+  };
+
+  for (size_t n : {size_t(0), size_t(3 * 65536), bytes.size()}) {
+    write(n);
+    std::vector<uint8_t> expected(bytes.begin(), bytes.begin() + n);
+    for (size_t buffers : {1, 2, 3}) {
+      for (bool direct : {false, true}) {
+        EXPECT_EQ(read({65536, buffers, direct}), expected);
+      }
+    }
+  }
+
+  // Stopping early does not wait for the rest of the file.
+  {
+    AsyncReader reader(path, {4096, 2, true});
+    EXPECT_EQ(reader.next().size(), 4096);
+  }
+
+  // A pipe cannot be read with `pread`.
+  fs::remove(path);
+  ASSERT_EQ(::mkfifo(path.c_str(), 0600), 0);
+  std::thread writer([&] () {write(bytes.size());});
+  EXPECT_EQ(read({}), bytes);
+  writer.join();
+  fs::remove(path);
+
+  EXPECT_THROW(AsyncReader reader(path), std::system_error);
+}
+
+TEST(FingerprintStream, matches_generator) {
+  using namespace satz::rabin;
+
+  auto [fg, fp] = FingerprintGenerator::create();
+  auto bytes = make_corpus(20000);
+
+  // Writes of every size up to a few buffers, ending anywhere.
+  FingerprintStream stream(fg, fp);
+  std::mt19937_64   engine(7);
+  for (size_t i = 0; i < bytes.size();) {
+    size_t n = std::min<size_t>(bytes.size() - i,
+                                engine() % 4 ? engine() % 17 : engine() % 2000);
+    stream.update(gsl::span<const uint8_t>(bytes.data() + i, n));
+    i += n;
+    ASSERT_EQ(stream.digest(), fg(fp, bytes.data(), bytes.data() + i));
+    ASSERT_EQ(stream.length(), i);
+  }
+
+  stream.reset(fp);
+  Fingerprint expected = fp;
+  for (int i = 0; i < 1000; ++i) {
+    stream.update(uint8_t(i)).update(uint16_t(i * 3)).update(uint32_t(i))
+          .update(uint64_t(i) << 40);
+    expected = fg(expected, uint8_t(i));
+    expected = fg(expected, uint16_t(i * 3));
+    expected = fg(expected, uint32_t(i));
+    expected = fg(expected, uint64_t(i) << 40);
+  }
+  EXPECT_EQ(stream.digest(), expected);
+  EXPECT_EQ(stream.length(), 1000u * 15);
+
+  // Containers of bytes are byte strings, not scalars.
+  std::vector<uint8_t>   vector(bytes.begin(), bytes.begin() + 100);
+  std::array<uint8_t, 3> array{1, 2, 3};
+  stream.reset(fp);
+  stream.update(vector).update(array);
+  expected = fg(fp, vector.begin(), vector.end());
+  EXPECT_EQ(stream.digest(), fg(expected, array.begin(), array.end()));
+}
+
+TEST(FingerprintIndex, insert_find_release) {
+  using namespace satz::rabin;
+
+  FingerprintIndex index(1000);
+  EXPECT_FALSE(index.find(42));
+
+  auto r = index.insert(42, 7);
+  EXPECT_TRUE(r.inserted);
+  EXPECT_EQ(r.location, 7u);
+  r = index.insert(42, 8);
+  EXPECT_FALSE(r.inserted);
+  EXPECT_EQ(r.location, 7u);
+  EXPECT_EQ(index.find(42)->refcount, 2u);
+
+  // Key 0 is an empty slot in the table and lives on the side.
+  EXPECT_FALSE(index.find(0));
+  EXPECT_TRUE(index.insert(0, 9).inserted);
+  EXPECT_EQ(index.find(0)->location, 9u);
+  EXPECT_EQ(index.size(), 2u);
+
+  EXPECT_EQ(index.release(42), 1u);
+  EXPECT_EQ(index.release(42), 0u);
+  EXPECT_EQ(index.release(42), 0u);
+  EXPECT_EQ(index.release(43), 0u);
+  EXPECT_EQ(index.find(42)->refcount, 0u);
+
+  // Fill up to the capacity, with batched insertion and lookup.
+  std::mt19937_64 engine(11);
+  std::vector<Fingerprint> keys(998);
+  std::vector<uint64_t>    locations(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i]      = engine() | 1;
+    locations[i] = i;
+  }
+  std::vector<FingerprintIndex::Insertion> inserted(keys.size());
+  index.insert(keys, locations, inserted);
+  std::vector<std::optional<FingerprintIndex::Entry>> found(keys.size());
+  index.find(keys, found);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(inserted[i].inserted);
+    ASSERT_TRUE(found[i]);
+    ASSERT_EQ(found[i]->location, i);
+  }
+  EXPECT_EQ(index.size(), index.capacity());
+  EXPECT_THROW(index.insert(2, 0), std::runtime_error);
+  EXPECT_FALSE(index.insert(42, 0).inserted);
+
+  size_t count = 0;
+  index.for_each([&] (Fingerprint, FingerprintIndex::Entry) { ++count; });
+  EXPECT_EQ(count, index.size());
+}
 
-  auto init_op = [&] () {
-    std::tie(fg,fp) = FingerprintGenerator::create();
+TEST(FingerprintIndex, concurrent_insertion) {
+  using namespace satz::rabin;
+
+  const size_t   n       = 100000;
+  const unsigned threads = 4;
+  FingerprintIndex index(n);
+
+  // Every thread inserts every key, in its own order.
+  std::vector<Fingerprint> keys(n);
+  std::mt19937_64 engine(13);
+  for (auto& k : keys) k = engine();
+
+  std::atomic<size_t> inserted = 0;
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] () {
+      std::vector<Fingerprint> mine(keys);
+      std::shuffle(mine.begin(), mine.end(), std::mt19937_64(t));
+      for (auto k : mine) {
+        if (index.insert(k, k / 2).inserted) ++inserted;
+      }
+    });
+  }
+  for (auto& w : workers) w.join();
+
+  EXPECT_EQ(inserted, n);
+  EXPECT_EQ(index.size(), n);
+  for (auto k : keys) {
+    auto e = index.find(k);
+    ASSERT_TRUE(e);
+    ASSERT_EQ(e->location, k / 2);
+    ASSERT_EQ(e->refcount, threads);
+  }
+}
+
+TEST(FingerprintIndex, snapshot) {
+  using namespace satz::rabin;
+  namespace fs = std::filesystem;
+
+  auto path = fs::temp_directory_path() / "rabin_fingerprint_index.t";
+
+  FingerprintIndex index(5000);
+  std::mt19937_64  engine(17);
+  for (int i = 0; i < 4000; ++i) index.insert(engine(), i);
+  index.insert(0, 4000);
+  index.save(path);
+
+  auto copy = FingerprintIndex::open(path);
+  EXPECT_EQ(copy.size(), index.size());
+  EXPECT_EQ(copy.capacity(), index.capacity());
+  size_t matched = 0;
+  index.for_each([&] (Fingerprint k, FingerprintIndex::Entry e) {
+    auto f = copy.find(k);
+    matched += f && f->location == e.location && f->refcount == e.refcount;
+  });
+  EXPECT_EQ(matched, index.size());
+
+  // A mapped index takes updates, without changing the file.
+  EXPECT_TRUE(copy.insert(1, 1).inserted);
+  EXPECT_FALSE(FingerprintIndex::open(path).find(1));
+
+  // Each field of the header, corrupted in turn.
+  std::vector<char> saved(fs::file_size(path));
+  std::ifstream(path, std::ios::binary).read(saved.data(),
+                                             std::streamsize(saved.size()));
+  auto corrupt = [&] (size_t offset, uint64_t value, size_t size) {
+    auto bytes = saved;
+    std::memcpy(bytes.data() + offset, &value, size);
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), std::streamsize(bytes.size()));
+    return path;
+  };
+  uint64_t buckets, capacity;
+  std::memcpy(&buckets, saved.data() + 16, 8);
+  std::memcpy(&capacity, saved.data() + 24, 8);
+  EXPECT_NO_THROW(FingerprintIndex::open(corrupt(0, 'R', 1)));
+  EXPECT_THROW(FingerprintIndex::open(corrupt(0, 'X', 1)),
+               std::runtime_error);
+  EXPECT_THROW(FingerprintIndex::open(corrupt(4, 2, 2)), std::runtime_error);
+  EXPECT_THROW(FingerprintIndex::open(corrupt(8, 0x04030201, 4)),
+               std::runtime_error);
+  for (uint64_t b : {uint64_t(0), buckets - 1, buckets + 1,
+                     uint64_t(1) << 58, ~uint64_t(0)}) {
+    EXPECT_THROW(FingerprintIndex::open(corrupt(16, b, 8)),
+                 std::runtime_error) << b << " buckets";
+  }
+  // Buckets have three slots.
+  for (uint64_t c : {index.size() - 1, buckets * 3,
+                     ~uint64_t(0)}) {
+    EXPECT_THROW(FingerprintIndex::open(corrupt(24, c, 8)),
+                 std::runtime_error) << "capacity " << c;
+  }
+  EXPECT_THROW(FingerprintIndex::open(corrupt(32, capacity + 1, 8)),
+               std::runtime_error);
+
+  fs::resize_file(path, saved.size() - 1);
+  EXPECT_THROW(FingerprintIndex::open(path), std::runtime_error);
+  fs::remove(path);
+}
+
+TEST(GeneratorFamily, members) {
+  using namespace satz::rabin;
+
+  GeneratorFamily family(20, 7);
+  EXPECT_EQ(family.size(), 20u);
+
+  auto polys = family.polynomials();
+  EXPECT_EQ(std::set<Fingerprint>(polys.begin(), polys.end()).size(), 20u);
+  EXPECT_TRUE(std::equal(polys.begin(), polys.end(),
+                         GeneratorFamily(20, 7).polynomials().begin()));
+
+  auto bytes = make_corpus(5000);
+  for (size_t i = 0; i < family.size(); ++i) {
+    auto member = family[i];
+    auto tables = member.tables();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(tables.data()) % 64, 0u);
+
+    FingerprintGenerator fg(member.polynomial());
+    ASSERT_TRUE(std::equal(tables.begin(), tables.end(),
+                           fg.tables().begin()));
+    for (size_t n : {0, 7, 100, 5000}) {
+      EXPECT_EQ(member(~Fingerprint(0), bytes.begin(), bytes.begin() + n),
+                fg(~Fingerprint(0), bytes.begin(), bytes.begin() + n));
+    }
+  }
+}
+
+TEST(GeneratorFamily, minhash_sketch) {
+  using namespace satz::rabin;
+  using detail::sketch_kernel;
+
+  GeneratorFamily family(37, 11);
+  std::vector<uint64_t> shingles(1000);
+  std::mt19937_64 engine(3);
+  for (auto& s : shingles) s = engine();
+
+  // $h_g(s)$ is the fingerprint of eight zero bytes starting from s.
+  std::vector<Fingerprint> expected(family.size(), ~Fingerprint(0));
+  const uint8_t zeros[8] = {};
+  for (size_t g = 0; g < family.size(); ++g) {
+    FingerprintGenerator fg(family.polynomials()[g]);
+    for (auto s : shingles) {
+      expected[g] = std::min(expected[g], fg(s, zeros, zeros + 8));
+    }
+  }
+  EXPECT_EQ(minhash_sketch(family, shingles), expected);
+
+  std::vector<sketch_kernel> kernels = {sketch_kernel::tables};
+  if (satz::cpu::has_pclmul()) kernels.push_back(sketch_kernel::clmul);
+  if (satz::cpu::has_vpclmul()) kernels.push_back(sketch_kernel::vpclmul);
+  for (auto kernel : kernels) {
+    std::vector<Fingerprint> sketch(family.size());
+    detail::minhash_sketch(family, shingles, sketch, kernel);
+    EXPECT_EQ(sketch, expected) << int(kernel);
+    detail::minhash_sketch(family, {}, sketch, kernel);
+    EXPECT_EQ(sketch, std::vector<Fingerprint>(family.size(),
+                                               ~Fingerprint(0)));
+  }
+
+  // Two sets sharing half of their union resemble each other by 1/2.
+  GeneratorFamily large(512, 13);
+  std::vector<uint64_t> a(shingles.begin(), shingles.begin() + 750);
+  std::vector<uint64_t> b(shingles.begin() + 250, shingles.end());
+  double r = minhash_resemblance(minhash_sketch(large, a),
+                                 minhash_sketch(large, b));
+  EXPECT_NEAR(r, 0.5, 0.1);
+}
+
+TEST(RollingFingerprint, correctness) {
+  using namespace satz::rabin;
+
+  auto fg    = FingerprintGenerator::create().first;
+  auto bytes = satz::bytes::make_random_bytes(1000);
+
+  for (size_t width : {1, 2, 8, 48, 257}) {
+    RollingFingerprint rf(fg, width);
+    auto fps = rf.roll(bytes);
+    ASSERT_EQ(fps.size(), bytes.size() - width + 1);
+
+    for (size_t i = 0; i < fps.size(); ++i) {
+      auto expected = fg(Fingerprint(0),
+                         bytes.begin() + i,
+                         bytes.begin() + i + width);
+      ASSERT_EQ(fps[i], expected) << "width " << width << ", position " << i;
+    }
+
+    auto fp = rf(bytes);
+    EXPECT_EQ(rf.push(rf.pop(fp, bytes[0]), bytes[width]), fps[1]);
+  }
+
+  RollingFingerprint rf(fg, 16);
+  EXPECT_TRUE(rf.roll(gsl::span<const uint8_t>(bytes.data(), 15)).empty());
+}
+
+TEST(PatternMatcher, matches_naive_search) {
+  using namespace satz::rabin;
+  using Match = PatternMatcher::Match;
+
+  // A small alphabet makes for many matches.
+  std::mt19937_64 engine(23);
+  std::vector<uint8_t> haystack(5000);
+  for (auto& c : haystack) c = uint8_t('a' + engine() % 3);
+
+  std::vector<std::vector<uint8_t>> patterns;
+  for (int i = 0; i < 200; ++i) {
+    std::vector<uint8_t> p(1 + engine() % 12);
+    for (auto& c : p) c = uint8_t('a' + engine() % 3);
+    patterns.push_back(p);
+  }
+  patterns.push_back(patterns[7]);
+  patterns.push_back(std::vector<uint8_t>(6000, 'a'));
+
+  std::vector<gsl::span<const uint8_t>> views(patterns.begin(),
+                                              patterns.end());
+  for (auto fg : {FingerprintGenerator::create().first,
+                  FingerprintGenerator(0x1b)}) {
+    PatternMatcher matcher(fg, views);
+    EXPECT_EQ(matcher.size(), patterns.size());
+
+    std::vector<Match> expected;
+    for (size_t i = 0; i + 1 <= haystack.size(); ++i) {
+      for (size_t k = 0; k < patterns.size(); ++k) {
+        const auto& p = patterns[k];
+        if (i + p.size() <= haystack.size() &&
+            std::equal(p.begin(), p.end(), haystack.begin() + i)) {
+          expected.push_back({i, k});
+        }
+      }
+    }
+    EXPECT_EQ(matcher.find(haystack), expected);
+  }
+
+  PatternMatcher matcher(FingerprintGenerator::create().first, views);
+  EXPECT_TRUE(matcher.find(gsl::span<const uint8_t>()).empty());
+}
+
+TEST(PatternMatcher, block_boundary) {
+  using namespace satz::rabin;
+  using Match = PatternMatcher::Match;
+
+  // Four groups scanned together, of which the longest stops where the
+  // first block of 64 KiB does, while the shorter ones carry on.
+  std::vector<std::vector<uint8_t>> patterns;
+  for (size_t len = 8; len <= 11; ++len) {
+    patterns.emplace_back(len, uint8_t('a' + len));
+  }
+  std::vector<uint8_t> haystack(65546, '.');
+  std::copy(patterns[0].begin(), patterns[0].end(), haystack.begin() + 100);
+  std::copy(patterns[0].begin(), patterns[0].end(),
+            haystack.begin() + 65536);
+
+  std::vector<gsl::span<const uint8_t>> views(patterns.begin(),
+                                              patterns.end());
+  PatternMatcher matcher(FingerprintGenerator::create().first, views);
+  EXPECT_EQ(matcher.find(haystack),
+            (std::vector<Match>{{100, 0}, {65536, 0}}));
+}
+
+TEST(Winnower, matches_definition) {
+  using namespace satz::rabin;
+
+  auto fg  = FingerprintGenerator::create().first;
+  auto doc = make_corpus(3000, 31);
+  // Repeated bytes make for ties between k-grams.
+  std::fill(doc.begin() + 1000, doc.begin() + 1400, 'x');
+
+  for (auto [k, w] : {std::pair<size_t, size_t>{1, 1}, {5, 4}, {32, 16},
+                      {16, 100}}) {
+    RollingFingerprint rf(fg, k);
+    auto fps = rf.roll(doc);
+
+    // The rightmost minimum of every window, without repeats.
+    std::vector<Selection> expected;
+    for (size_t i = 0; i + w <= fps.size(); ++i) {
+      size_t min = i;
+      for (size_t j = i; j < i + w; ++j) {
+        if (fps[j] <= fps[min]) min = j;
+      }
+      if (expected.empty() || expected.back().position != min) {
+        expected.push_back({fps[min], min});
+      }
+    }
+
+    Winnower winnower(fg, {k, w});
+    EXPECT_EQ(winnower.select(doc), expected) << k << " " << w;
+
+    // Pieces of any size give the same selections.
+    std::vector<Selection> pieces;
+    auto emit = [&] (const Selection& s) { pieces.push_back(s); };
+    std::mt19937_64 engine(k);
+    for (size_t pos = 0; pos < doc.size();) {
+      size_t n = std::min<size_t>(engine() % 100, doc.size() - pos);
+      winnower.update(gsl::span(doc).subspan(pos, n), emit);
+      pos += n;
+    }
+    winnower.finish(emit);
+    EXPECT_EQ(pieces, expected);
+  }
+
+  // A document too short for a window yields its smallest k-gram.
+  Winnower winnower(fg, {8, 16});
+  auto     shorter = gsl::span(doc).first(20);
+  auto     fps     = RollingFingerprint(fg, 8).roll(shorter);
+  auto     min     = std::min_element(fps.begin(), fps.end());
+  std::vector<Selection> expected = {{*min, size_t(min - fps.begin())}};
+  EXPECT_EQ(winnower.select(shorter), expected);
+  EXPECT_TRUE(winnower.select(gsl::span(doc).first(7)).empty());
+}
+
+TEST(Winnower, resemblance) {
+  using namespace satz::rabin;
+
+  Winnower winnower(FingerprintGenerator::create().first);
+  auto a = make_corpus(64 * 1024, 1);
+  auto b = a;
+  // Change one byte in every 4 KiB.
+  for (size_t i = 2048; i < b.size(); i += 4096) b[i] ^= 0xff;
+  auto c = make_corpus(64 * 1024, 2);
+
+  std::vector<Fingerprint> sa, sb, sc;
+  signature(winnower.select(a), sa);
+  signature(winnower.select(b), sb);
+  signature(winnower.select(c), sc);
+
+  EXPECT_EQ(resemblance(sa, sa), 1.0);
+  EXPECT_GT(resemblance(sa, sb), 0.9);
+  EXPECT_LT(resemblance(sa, sb), 1.0);
+  EXPECT_EQ(resemblance(sa, sc), 0.0);
+  EXPECT_EQ(resemblance({}, {}), 1.0);
+  EXPECT_EQ(resemblance(sa, {}), 0.0);
+}
+
+TEST(Chunker, chunk_sizes) {
+  using namespace satz::rabin;
+
+  ChunkerConfig config;
+  Chunker       chunker(FingerprintGenerator::create().first, config);
+
+  auto corpus = make_corpus(4 << 20);
+  auto cuts   = chunker.cut_points(corpus);
+  ASSERT_FALSE(cuts.empty());
+  EXPECT_EQ(cuts.back(), corpus.size());
+
+  size_t prev = 0;
+  for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+    EXPECT_GE(cuts[i] - prev, config.min_size);
+    EXPECT_LE(cuts[i] - prev, config.max_size);
+    prev = cuts[i];
+  }
+
+  double avg = 1.0 * corpus.size() / cuts.size();
+  EXPECT_GT(avg, config.min_size);
+  EXPECT_LT(avg, 2.0 * config.avg_size);
+}
+
+TEST(Chunker, stream_matches_buffer) {
+  using namespace satz::rabin;
+
+  Chunker chunker(FingerprintGenerator::create().first);
+
+  auto corpus = make_corpus(1 << 20);
+  std::istringstream in(std::string(corpus.begin(), corpus.end()));
+
+  std::vector<size_t> cuts;
+  uint64_t total = chunker.for_each_chunk(
+      in,
+      [&] (gsl::span<const uint8_t> chunk) {
+        cuts.push_back((cuts.empty() ? 0 : cuts.back()) + chunk.size());
+      });
+
+  EXPECT_EQ(total, corpus.size());
+  EXPECT_EQ(cuts, chunker.cut_points(corpus));
+}
+
+TEST(Chunker, shift_resistance) {
+  using namespace satz::rabin;
+
+  Chunker chunker(FingerprintGenerator::create().first);
+
+  auto corpus  = make_corpus(1 << 20);
+  auto shifted = make_corpus(100, 7);
+  shifted.insert(shifted.end(), corpus.begin(), corpus.end());
+
+  auto cuts = chunker.cut_points(corpus);
+  auto more = chunker.cut_points(shifted);
+  for (auto& c : more) c -= 100;
+
+  std::vector<size_t> common;
+  std::set_intersection(cuts.begin(), cuts.end(),
+                        more.begin(), more.end(),
+                        std::back_inserter(common));
+  EXPECT_GE(common.size(), cuts.size() * 9 / 10);
+}
+
+TEST(ThreadPool, nested_tasks) {
+  using namespace satz::rabin;
+
+  ThreadPool            pool(4);
+  std::atomic<uint64_t> sum = 0;
+  for (uint64_t i = 0; i < 100; ++i) {
+    pool.submit([&, i] () {
+      for (uint64_t j = 0; j < 10; ++j) {
+        pool.submit([&, i, j] () {sum += i * 10 + j;});
+      }
+    });
+  }
+  pool.wait();
+  EXPECT_EQ(sum, 999u * 1000 / 2);
+
+  pool.submit([] () {throw std::runtime_error("task");});
+  pool.submit([&] () {++sum;});
+  EXPECT_THROW(pool.wait(), std::runtime_error);
+  EXPECT_EQ(sum, 999u * 1000 / 2 + 1);
+  EXPECT_NO_THROW(pool.wait());
+}
+
+TEST(Scan, matches_sequential_chunking) {
+  using namespace satz::rabin;
+  namespace fs = std::filesystem;
+
+  auto root = fs::temp_directory_path() / "rabin_scan.t";
+  fs::remove_all(root);
+  fs::create_directories(root / "sub");
+  auto write = [] (const fs::path& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char*>(bytes.data()),
+               std::streamsize(bytes.size()));
   };
 
-  auto milliseconds = satz::measure::ms(std::ref(init_op));
-  std::cout << "four_byte_speed (construction): " << milliseconds << "ms\n";
+  // A file, a copy, an edited copy, a file made of one block repeated, and
+  // an empty file.
+  auto a = make_corpus(3 * 1024 * 1024, 1);
+  auto b = a;
+  b.insert(b.begin() + 1000000, 77, 0x55);
+  auto block = make_corpus(100 * 1024, 2);
+  std::vector<uint8_t> c;
+  for (int i = 0; i < 20; ++i) c.insert(c.end(), block.begin(), block.end());
+  write(root / "a", a);
+  write(root / "sub" / "a", a);
+  write(root / "sub" / "b", b);
+  write(root / "c", c);
+  write(root / "empty", {});
+  fs::create_symlink(root / "a", root / "link");
+
+  // What chunking each file in one piece finds.
+  ScanConfig config;
+  auto [fg, fp0] = FingerprintGenerator::create(config.seed);
+  Chunker chunker(fg, config.chunker);
+  uint64_t chunks = 0;
+  std::map<Fingerprint, uint64_t> unique;
+  for (const auto* bytes : {&a, &a, &b, &c}) {
+    size_t begin = 0;
+    for (size_t end : chunker.cut_points(*bytes)) {
+      unique[fg(fp0, bytes->data() + begin, bytes->data() + end)] =
+          end - begin;
+      begin = end;
+      ++chunks;
+    }
+  }
+  uint64_t unique_bytes = 0;
+  for (auto [fp, length] : unique) unique_bytes += length;
+
+  // Results do not depend on the threads or on segments.
+  for (auto [threads, segment] : {std::pair<unsigned, uint64_t>{1, 1 << 30},
+                                  {4, 256 * 1024},
+                                  {3, 20000}}) {
+    config.threads      = threads;
+    config.segment_size = segment;
+    std::vector<fs::path> roots = {root};
+    auto report = scan(roots, config);
+
+    EXPECT_TRUE(report.errors.empty());
+    EXPECT_EQ(report.files, 5u);
+    EXPECT_EQ(report.bytes, 2 * a.size() + b.size() + c.size());
+    EXPECT_EQ(report.chunks, chunks);
+    EXPECT_EQ(report.unique_chunks, unique.size());
+    EXPECT_EQ(report.unique_bytes, unique_bytes);
+    EXPECT_GT(report.dedup_ratio(), 2.5);
 
-  int count = 3000'000;
-  auto consume_op = [&] () {
-    for (int i = 0; i < count; ++i) {
-      fp = fg(fp, uint64_t(i));
+    ASSERT_FALSE(report.clusters.empty());
+    const auto& top = report.clusters.front();
+    EXPECT_GE(top.copies, 3u);
+    EXPECT_EQ(top.locations.size(), std::min<size_t>(top.copies, 8));
+    for (size_t i = 1; i < report.clusters.size(); ++i) {
+      EXPECT_GE(report.clusters[i - 1].saved(), report.clusters[i].saved());
     }
+  }
+
+  std::vector<fs::path> missing = {root / "missing"};
+  EXPECT_EQ(scan(missing, config).errors.size(), 1u);
+  fs::remove_all(root);
+}
+
+TEST(Polynomial, dense_matches_sparse) {
+  using Sparse = satz::gf2::v2::Polynomial;
+  using Dense  = satz::gf2::v3::Polynomial;
+
+  auto to_string = [] (const auto& p) {
+    std::ostringstream os;
+    os << p;
+    return os.str();
   };
-  auto nanoseconds = measure::ns(std::ref(consume_op));
-  double op_time = (1.0 * nanoseconds / count);
-  std::cout << "four_byte_speed (generation): " << op_time << "ns per call\n";
-  EXPECT_LE(op_time, 100);
+
+  for (int degree : {1, 5, 63, 64, 65, 127, 200}) {
+    auto a_bytes = satz::bytes::make_random_bytes(degree / 8 + 1);
+    auto b_bytes = satz::bytes::make_random_bytes((degree / 2 + 1) / 8 + 1);
+    auto a = Sparse::from_bytes(a_bytes, degree);
+    auto b = Sparse::from_bytes(b_bytes, degree / 2 + 1);
+    auto c = Dense::from_bytes(a_bytes, degree);
+    auto d = Dense::from_bytes(b_bytes, degree / 2 + 1);
+
+    EXPECT_EQ(to_string(a), to_string(c));
+    EXPECT_EQ(a.to_bytes(), c.to_bytes());
+    EXPECT_EQ(a.degree(), c.degree());
+    EXPECT_EQ(a.nnz(), c.nnz());
+    EXPECT_EQ((a ^ b).to_bytes(), (c ^ d).to_bytes());
+    EXPECT_EQ((a | b).to_bytes(), (c | d).to_bytes());
+    EXPECT_EQ((a & b).to_bytes(), (c & d).to_bytes());
+    EXPECT_EQ((a * b).to_bytes(), (c * d).to_bytes());
+    EXPECT_EQ((a % b).to_bytes(), (c % d).to_bytes());
+    EXPECT_EQ((b % a).to_bytes(), (d % c).to_bytes());
+    EXPECT_EQ((a << 77).to_bytes(), (c << 77).to_bytes());
+    EXPECT_EQ((c << 13) >> 13, c);
+    EXPECT_EQ((c >> 3) << 3, c ^ (c & Dense{0, 1, 2}));
+    EXPECT_EQ((c >> 64) << 64, c ^ (c % (Dense{64})));
+    EXPECT_EQ(a < b, c < d);
+    EXPECT_EQ(b < a, d < c);
+  }
+
+  EXPECT_EQ(Dense{0} * (Dense{3, 1}), (Dense{3, 1}));
+  EXPECT_TRUE(satz::is_irreducible(Dense{64, 4, 3, 1, 0}));
+  EXPECT_FALSE(satz::is_irreducible(Dense{64, 0}));
+}
+
+TEST(Polynomial, native_irreducibility) {
+  using Dense = satz::gf2::v3::Polynomial;
+  namespace native = satz::gf2::native;
+
+  auto to_native = [] (const Dense& p) {
+    native::poly_type r = 0;
+    auto words = p.words();
+    for (size_t i = words.size(); i-- > 0;) r = (r << 64) | words[i];
+    return r;
+  };
+
+  int irreducible = 0;
+  for (int degree = 1; degree <= 64; ++degree) {
+    for (int i = 0; i < 20; ++i) {
+      auto p = Dense::make_random(degree);
+      auto expected = satz::is_irreducible(p);
+      irreducible += expected;
+      ASSERT_EQ(native::is_irreducible(to_native(p)), expected) << p;
+    }
+    auto q = native::make_irreducible(degree);
+    EXPECT_EQ(native::degree(q), degree);
+    EXPECT_TRUE(native::is_irreducible(q));
+  }
+  EXPECT_GT(irreducible, 0);
+
+  EXPECT_TRUE(native::is_irreducible(to_native(Dense{64, 4, 3, 1, 0})));
+  EXPECT_FALSE(native::is_irreducible(to_native(Dense{64, 0})));
+  EXPECT_FALSE(native::is_irreducible(to_native(Dense{64, 32, 0})));
+}
+
+TEST(Polynomial, karatsuba_and_barrett) {
+  using Sparse = satz::gf2::v2::Polynomial;
+  using Dense  = satz::gf2::v3::Polynomial;
+  using satz::gf2::v3::detail::multiplication;
+  using satz::gf2::v3::detail::reduction;
+  namespace detail = satz::gf2::v3::detail;
+
+  // balanced and unbalanced, around the word counts where Karatsuba's
+  // method recurses
+  for (auto [da, db] : {std::pair{1023, 1023}, {1024, 1000}, {4000, 2100},
+                        {5000, 900}, {3000, 64}, {2047, 2049}}) {
+    auto a = Dense::make_random(da);
+    auto b = Dense::make_random(db);
+    auto expected = detail::multiply(a, b, multiplication::schoolbook);
+    EXPECT_EQ(detail::multiply(a, b, multiplication::karatsuba), expected);
+    EXPECT_EQ(detail::multiply(b, a, multiplication::karatsuba), expected);
+    EXPECT_EQ(a * b, expected);
+  }
+
+  // dividends of degree below, at, and far above twice the divisor's
+  for (int d : {1, 2, 63, 64, 65, 300, 1024, 2500}) {
+    auto m = Dense::make_random(d);
+    for (int da : {d - 1, d, 2 * d - 1, 2 * d, 5 * d + 17}) {
+      auto a = Dense::make_random(std::max(da, 0));
+      EXPECT_EQ(detail::remainder(a, m, reduction::barrett),
+                detail::remainder(a, m, reduction::bitwise))
+          << "d = " << d << ", deg a = " << da;
+    }
+  }
+
+  // v2 hands large operands to v3
+  auto a_bytes = satz::bytes::make_random_bytes(4000 / 8 + 1);
+  auto b_bytes = satz::bytes::make_random_bytes(1500 / 8 + 1);
+  auto a = Sparse::from_bytes(a_bytes, 4000);
+  auto b = Sparse::from_bytes(b_bytes, 1500);
+  auto c = Dense::from_bytes(a_bytes, 4000);
+  auto d = Dense::from_bytes(b_bytes, 1500);
+  EXPECT_EQ((a * b).to_bytes(), (c * d).to_bytes());
+  EXPECT_EQ((a % b).to_bytes(), (c % d).to_bytes());
+  EXPECT_EQ((a * b % a).to_bytes(), std::vector<uint8_t>{});
+}
+
+TEST(Polynomial, parallel_irreducible_search) {
+  using Dense = satz::gf2::v3::Polynomial;
+
+  for (int degree : {65, 128}) {
+    for (uint64_t seed : {0, 1}) {
+      auto expected = Dense::make_irreducible(degree, seed);
+      EXPECT_EQ(expected.degree(), degree);
+      EXPECT_TRUE(satz::is_irreducible(expected));
+      for (unsigned threads : {3, 8}) {
+        EXPECT_EQ(Dense::make_irreducible(degree, seed, threads), expected)
+            << "degree " << degree << ", seed " << seed << ", " << threads
+            << " threads";
+      }
+    }
+  }
+}
+
+TEST(Measure, repeat) {
+  using namespace std::chrono_literals;
+  using satz::measure;
+
+  auto bytes = make_corpus(4096);
+  auto [fg, fp] = satz::rabin::FingerprintGenerator::create(1);
+
+  satz::RepeatOptions options;
+  options.min_time    = 20ms;
+  options.min_samples = 7;
+  auto s = measure::repeat([&] () {
+    fp = fg(fp, bytes.begin(), bytes.end());
+  }, bytes.size(), options);
+
+  EXPECT_GE(s.samples, 7u);
+  EXPECT_GE(s.iterations, 1u);
+  EXPECT_EQ(s.bytes, bytes.size());
+  EXPECT_GT(s.min, 0);
+  EXPECT_LE(s.min, s.median);
+  EXPECT_LE(s.median, s.p99);
+
+  // Counters are optional, but counted ones are sensible.
+  if (satz::PerfCounters().available()) {
+    ASSERT_TRUE(s.counters.cycles);
+    EXPECT_GT(*s.cycles_per_byte(), 0);
+  } else {
+    EXPECT_FALSE(s.counters.cycles);
+    EXPECT_FALSE(s.cycles_per_byte());
+  }
+  if (s.counters.instructions) {
+    EXPECT_GT(*s.counters.instructions, 0);
+  }
 }
 
 }
@@ -0,0 +1,377 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "index.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace satz::rabin {
+
+namespace {
+
+constexpr uint32_t published_bit = 0x80000000u;
+
+// Entries stay below this fraction of the slots, which keeps probe
+// sequences short.
+constexpr double max_load = 0.85;
+
+// How many keys ahead batched operations prefetch.
+constexpr size_t prefetch_distance = 8;
+
+// The table is plain memory, so that it can be written to and mapped from
+// a file, and is accessed atomically through references.
+template <typename T>
+std::atomic_ref<T> atomic (const T& x) {
+  return std::atomic_ref<T>(const_cast<T&>(x));
+}
+
+void pause () {
+#if defined(__x86_64__)
+  _mm_pause();
+#endif
+}
+
+// Waits until the entry claimed by another thread is published.
+uint32_t wait_published (const uint32_t& count) {
+  uint32_t c;
+  while (!((c = atomic(count).load(std::memory_order_acquire))
+           & published_bit)) {
+    pause();
+  }
+  return c;
+}
+
+// Layout of a snapshot, in the byte order of the machine that wrote it.
+//
+//    offset  size  field
+//         0     4  magic "RBFI"
+//         4     2  format version
+//         6     2  reserved, 0
+//         8     4  0x01020304, to detect the byte order
+//        12     4  reserved, 0
+//        16     8  number of buckets
+//        24     8  capacity
+//        32     8  number of entries
+//        40    24  reserved, 0
+//        64    64  bucket of key 0
+//       128        buckets
+constexpr char     snapshot_magic[4] = {'R', 'B', 'F', 'I'};
+constexpr uint16_t snapshot_version  = 1;
+constexpr uint32_t byte_order_mark   = 0x01020304;
+constexpr size_t   snapshot_header   = 128;
+
+struct SnapshotHeader {
+  char     magic[4];
+  uint16_t version;
+  uint16_t reserved0;
+  uint32_t byte_order;
+  uint32_t reserved1;
+  uint64_t buckets;
+  uint64_t capacity;
+  uint64_t size;
+  uint8_t  reserved2[24];
+};
+static_assert(sizeof(SnapshotHeader) == 64);
+
+[[noreturn]] void throw_errno (const std::filesystem::path& path,
+                               const char* what) {
+  throw std::system_error(errno, std::generic_category(),
+                          std::string(what) + " " + path.string());
+}
+
+}
+
+FingerprintIndex::FingerprintIndex (size_t capacity) {
+  Expects(capacity > 0);
+
+  buckets_ = size_t(capacity / (slots * max_load)) + 1;
+  limit_   = capacity;
+
+  table_ = static_cast<Bucket*>(
+      std::aligned_alloc(alignof(Bucket), buckets_ * sizeof(Bucket)));
+  if (!table_) throw std::bad_alloc();
+  std::memset(static_cast<void*>(table_), 0, buckets_ * sizeof(Bucket));
+}
+
+FingerprintIndex::FingerprintIndex (FingerprintIndex&& other) noexcept {
+  *this = std::move(other);
+}
+
+FingerprintIndex& FingerprintIndex::operator = (
+    FingerprintIndex&& other) noexcept {
+
+  if (this == &other) return *this;
+  release_storage();
+  table_   = std::exchange(other.table_, nullptr);
+  buckets_ = std::exchange(other.buckets_, 0);
+  limit_   = std::exchange(other.limit_, 0);
+  size_.store(other.size_.exchange(0));
+  reserved_.store(other.reserved_.exchange(0));
+  zero_    = std::exchange(other.zero_, Bucket{});
+  map_     = std::exchange(other.map_, nullptr);
+  mapped_  = std::exchange(other.mapped_, 0);
+  return *this;
+}
+
+FingerprintIndex::~FingerprintIndex () {
+  release_storage();
+}
+
+void FingerprintIndex::release_storage () {
+  if (map_) {
+    ::munmap(map_, mapped_);
+  } else {
+    std::free(table_);
+  }
+  table_ = nullptr;
+  map_   = nullptr;
+}
+
+std::optional<FingerprintIndex::Entry> FingerprintIndex::published (
+    const Bucket& b, int i) {
+
+  if (!atomic(b.keys[i]).load(std::memory_order_acquire)) return {};
+  uint32_t c = atomic(b.counts[i]).load(std::memory_order_acquire);
+  if (!(c & published_bit)) return {};
+  return Entry{atomic(b.locations[i]).load(std::memory_order_relaxed),
+               c & ~published_bit};
+}
+
+// Inserts into slot `i` of `b` if it is free or holds `key`, and sets
+// `done`; leaves `done` alone if the slot holds another key.
+FingerprintIndex::Insertion FingerprintIndex::insert_at (
+    Bucket& b, int i, uint64_t key, uint64_t location, bool& done) {
+
+  auto     k   = atomic(b.keys[i]);
+  uint64_t cur = k.load(std::memory_order_acquire);
+  if (cur == 0) {
+    // A place is reserved before the slot is claimed, so that racing
+    // insertions cannot store more than `limit_` entries between them, and
+    // given back if another thread claims the slot first. While the places
+    // left are only reserved, the index is not full yet.
+    while (reserved_.fetch_add(1, std::memory_order_relaxed) >= limit_) {
+      reserved_.fetch_sub(1, std::memory_order_relaxed);
+      cur = k.load(std::memory_order_acquire);
+      if (cur != 0) break;
+      if (size_.load(std::memory_order_relaxed) >= limit_) {
+        throw std::runtime_error("fingerprint index is full");
+      }
+      std::this_thread::yield();
+    }
+    if (cur == 0) {
+      if (k.compare_exchange_strong(cur, key, std::memory_order_acq_rel)) {
+        atomic(b.locations[i]).store(location, std::memory_order_relaxed);
+        atomic(b.counts[i]).store(published_bit | 1,
+                                  std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        done = true;
+        return {location, true};
+      }
+      reserved_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+  if (cur != key) return {};
+
+  wait_published(b.counts[i]);
+  atomic(b.counts[i]).fetch_add(1, std::memory_order_acq_rel);
+  done = true;
+  return {atomic(b.locations[i]).load(std::memory_order_relaxed), false};
+}
+
+FingerprintIndex::Insertion FingerprintIndex::insert (Fingerprint key,
+                                                      uint64_t location) {
+  bool done = false;
+  if (key == 0) return insert_at(zero_, 0, 1, location, done);
+
+  // Every probe sequence ends at an empty slot, since the load is capped.
+  for (size_t b = bucket_of(key);; b = b + 1 == buckets_ ? 0 : b + 1) {
+    for (int i = 0; i < slots; ++i) {
+      auto ret = insert_at(table_[b], i, key, location, done);
+      if (done) return ret;
+    }
+  }
+}
+
+void FingerprintIndex::insert (gsl::span<const Fingerprint> keys,
+                               gsl::span<const uint64_t> locations,
+                               gsl::span<Insertion> out) {
+  Expects(keys.size() == locations.size() && keys.size() == out.size());
+
+  const size_t n = keys.size();
+  for (size_t i = 0; i < n; ++i) {
+    if (i + prefetch_distance < n) {
+      __builtin_prefetch(&table_[bucket_of(keys[i + prefetch_distance])], 1);
+    }
+    out[i] = insert(keys[i], locations[i]);
+  }
+}
+
+std::optional<FingerprintIndex::Entry> FingerprintIndex::find (
+    Fingerprint key) const {
+
+  if (key == 0) return published(zero_, 0);
+
+  for (size_t b = bucket_of(key);; b = b + 1 == buckets_ ? 0 : b + 1) {
+    const Bucket& bucket = table_[b];
+    for (int i = 0; i < slots; ++i) {
+      uint64_t cur = atomic(bucket.keys[i]).load(std::memory_order_acquire);
+      if (cur == 0) return {};
+      if (cur != key) continue;
+
+      uint32_t c = wait_published(bucket.counts[i]);
+      return Entry{atomic(bucket.locations[i]).load(std::memory_order_relaxed),
+                   c & ~published_bit};
+    }
+  }
+}
+
+void FingerprintIndex::find (gsl::span<const Fingerprint> keys,
+                             gsl::span<std::optional<Entry>> out) const {
+  Expects(keys.size() == out.size());
+
+  const size_t n = keys.size();
+  for (size_t i = 0; i < n; ++i) {
+    if (i + prefetch_distance < n) {
+      __builtin_prefetch(&table_[bucket_of(keys[i + prefetch_distance])], 0);
+    }
+    out[i] = find(keys[i]);
+  }
+}
+
+uint32_t FingerprintIndex::release (Fingerprint key) {
+  Bucket* bucket = nullptr;
+  int     slot   = 0;
+  if (key == 0) {
+    if (atomic(zero_.keys[0]).load(std::memory_order_acquire)) bucket = &zero_;
+  } else {
+    for (size_t b = bucket_of(key); !bucket;
+         b = b + 1 == buckets_ ? 0 : b + 1) {
+      for (slot = 0; slot < slots; ++slot) {
+        uint64_t cur = atomic(table_[b].keys[slot])
+                           .load(std::memory_order_acquire);
+        if (cur == 0) return 0;
+        if (cur == key) {
+          bucket = &table_[b];
+          break;
+        }
+      }
+    }
+  }
+  if (!bucket) return 0;
+
+  auto     count = atomic(bucket->counts[slot]);
+  uint32_t c     = wait_published(bucket->counts[slot]);
+  while ((c & ~published_bit) &&
+         !count.compare_exchange_weak(c, c - 1, std::memory_order_acq_rel)) { }
+  return (c & ~published_bit) ? (c & ~published_bit) - 1 : 0;
+}
+
+void FingerprintIndex::save (const std::filesystem::path& path) const {
+  SnapshotHeader h{};
+  std::memcpy(h.magic, snapshot_magic, sizeof(h.magic));
+  h.version    = snapshot_version;
+  h.byte_order = byte_order_mark;
+  h.buckets    = buckets_;
+  h.capacity   = limit_;
+  h.size       = size();
+
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) throw_errno(path, "cannot create");
+
+  auto write_all = [&] (const void* data, size_t n) {
+    auto p = static_cast<const uint8_t*>(data);
+    while (n) {
+      ssize_t w = ::write(fd, p, n);
+      if (w < 0 && errno == EINTR) continue;
+      if (w < 0) {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        throw_errno(path, "cannot write");
+      }
+      p += w;
+      n -= size_t(w);
+    }
+  };
+  write_all(&h, sizeof(h));
+  write_all(&zero_, sizeof(zero_));
+  write_all(table_, buckets_ * sizeof(Bucket));
+  if (::close(fd) < 0) throw_errno(path, "cannot write");
+}
+
+FingerprintIndex FingerprintIndex::open (const std::filesystem::path& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) throw_errno(path, "cannot open");
+
+  struct stat st{};
+  if (::fstat(fd, &st) < 0) {
+    int err = errno;
+    ::close(fd);
+    errno = err;
+    throw_errno(path, "cannot stat");
+  }
+  const auto n = static_cast<size_t>(st.st_size);
+  if (n < snapshot_header) {
+    ::close(fd);
+    throw std::runtime_error("not a fingerprint index snapshot");
+  }
+
+  // A private writable mapping: the index can be updated in place, and
+  // the file is left as it was.
+  void* map = ::mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  int err = errno;
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    errno = err;
+    throw_errno(path, "cannot map");
+  }
+
+  FingerprintIndex index;
+  index.map_    = map;
+  index.mapped_ = n;
+
+  SnapshotHeader h;
+  std::memcpy(&h, map, sizeof(h));
+  if (std::memcmp(h.magic, snapshot_magic, sizeof(h.magic)) != 0 ||
+      h.version != snapshot_version || h.byte_order != byte_order_mark ||
+      h.buckets == 0 ||
+      h.buckets > (SIZE_MAX - snapshot_header) / sizeof(Bucket) ||
+      n != snapshot_header + h.buckets * sizeof(Bucket)) {
+    throw std::runtime_error("not a fingerprint index snapshot");
+  }
+  // A table claimed fuller than the constructor allows would let probes
+  // run forever.
+  if (h.size > h.capacity ||
+      double(h.capacity) > double(h.buckets) * slots * max_load) {
+    throw std::runtime_error("corrupt fingerprint index snapshot");
+  }
+
+  auto base = static_cast<uint8_t*>(map);
+  std::memcpy(&index.zero_, base + sizeof(h), sizeof(Bucket));
+  index.table_   = reinterpret_cast<Bucket*>(base + snapshot_header);
+  index.buckets_ = h.buckets;
+  index.limit_   = h.capacity;
+  index.size_.store(h.size);
+  index.reserved_.store(h.size);
+  ::madvise(map, n, MADV_RANDOM);
+  return index;
+}
+
+}
@@ -0,0 +1,180 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Content-addressed index from fingerprints to chunk locations,
+ *    with a reference count per chunk, for deduplicating stores.
+ *
+ *    The index is an open-addressing hash table of 64-byte buckets, each
+ *    holding three keys, their locations and their reference counts, so
+ *    that a lookup touches a single cache line unless its bucket has
+ *    overflowed into the next one. Fingerprints are uniformly distributed
+ *    already and pick their bucket directly.
+ *
+ *    `insert`, `find` and `release` may be called from any number of
+ *    threads at once; insertion claims a slot with a compare-and-swap on its
+ *    key and publishes the entry through its reference count, so readers
+ *    never see a half-written entry. Entries are never removed: a count
+ *    that drops to zero only tells the store that the chunk is unused.
+ *
+ *    The capacity is fixed when the index is created; inserting past it
+ *    throws `std::runtime_error`.
+ *
+ *    Locations are opaque to the index: any 64-bit value the store finds
+ *    a chunk by, such as an offset into a container file. `scan`, which
+ *    keeps no chunks, stores their lengths there instead.
+ */
+class FingerprintIndex {
+public:
+  struct Entry {
+    uint64_t location; // as given to `insert` by the first reference
+    uint32_t refcount;
+  };
+
+  struct Insertion {
+    uint64_t location; // location of the chunk in the index
+    bool     inserted; // whether the chunk was new
+  };
+
+  /**
+   * @param capacity number of entries the index must be able to hold
+   */
+  explicit FingerprintIndex (size_t capacity);
+
+  FingerprintIndex (FingerprintIndex&& other) noexcept;
+  FingerprintIndex& operator = (FingerprintIndex&& other) noexcept;
+  FingerprintIndex (const FingerprintIndex&) = delete;
+  FingerprintIndex& operator = (const FingerprintIndex&) = delete;
+  ~FingerprintIndex ();
+
+  /**
+   * @brief Adds a reference to the chunk with the given fingerprint,
+   *    stored at `location` if the chunk is new.
+   * @return the location of the chunk, and whether it was new
+   * @throw std::runtime_error if the index is full
+   */
+  Insertion insert (Fingerprint key, uint64_t location);
+
+  /**
+   * @brief Inserts several keys, prefetching the buckets of upcoming keys
+   *    while the current one is being inserted.
+   * @pre keys, locations and out have the same size
+   */
+  void insert (gsl::span<const Fingerprint> keys,
+               gsl::span<const uint64_t> locations,
+               gsl::span<Insertion> out);
+
+  [[nodiscard]] std::optional<Entry> find (Fingerprint key) const;
+
+  /**
+   * @brief Looks up several keys, prefetching the buckets of upcoming keys.
+   * @pre keys and out have the same size
+   */
+  void find (gsl::span<const Fingerprint> keys,
+             gsl::span<std::optional<Entry>> out) const;
+
+  /**
+   * @brief Drops a reference to the chunk with the given fingerprint.
+   * @return the remaining number of references, or 0 if the chunk is not
+   *    in the index or has no references left
+   */
+  uint32_t release (Fingerprint key);
+
+  /**
+   * @brief Calls `f(key, entry)` for every entry, in no particular order.
+   */
+  template <typename F>
+  void for_each (F f) const {
+    for (size_t b = 0; b < buckets_; ++b) {
+      for (int i = 0; i < slots; ++i) {
+        if (auto e = published(table_[b], i)) f(table_[b].keys[i], *e);
+      }
+    }
+    if (auto e = published(zero_, 0)) f(Fingerprint(0), *e);
+  }
+
+  [[nodiscard]] size_t size () const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] size_t capacity () const {return limit_;}
+
+  /**
+   * @brief Returns the size of the table in bytes.
+   */
+  [[nodiscard]] size_t memory_usage () const {return buckets_ * 64;}
+
+  /**
+   * @brief Writes a snapshot of the index, which `open` maps back into
+   *    memory without reading or rebuilding it.
+   *
+   *    The snapshot is the table itself behind a 64-byte header, in the
+   *    byte order of the machine. It must not be taken while other threads
+   *    insert into the index.
+   *
+   * @throw std::system_error if the file cannot be written
+   */
+  void save (const std::filesystem::path& path) const;
+
+  /**
+   * @brief Maps a snapshot written by `save` into memory. Pages are read
+   *    on first access, and changes to the index are private to the
+   *    process until it is saved again.
+   * @throw std::system_error if the file cannot be opened or mapped
+   * @throw std::runtime_error if it is not a snapshot of this format
+   */
+  static FingerprintIndex open (const std::filesystem::path& path);
+
+private:
+  static constexpr int slots = 3;
+
+  // One cache line. The high bit of a count is set once the entry is
+  // published, and key 0 marks an empty slot.
+  struct alignas(64) Bucket {
+    uint64_t keys[slots];
+    uint64_t locations[slots];
+    uint32_t counts[slots];
+    uint32_t reserved;
+  };
+  static_assert(sizeof(Bucket) == 64);
+
+  FingerprintIndex () = default;
+
+  static std::optional<Entry> published (const Bucket& b, int i);
+
+  size_t bucket_of (Fingerprint key) const {
+    return size_t((unsigned __int128)key * buckets_ >> 64);
+  }
+
+  Insertion insert_at (Bucket& b, int i, uint64_t key, uint64_t location,
+                       bool& done);
+
+  void release_storage ();
+
+  Bucket*             table_   = nullptr;
+  size_t              buckets_ = 0;
+  size_t              limit_   = 0;
+  std::atomic<size_t> size_    = 0;
+  // entries, plus the places reserved by insertions under way
+  std::atomic<size_t> reserved_ = 0;
+  // Key 0 lives in slot 0 of a bucket of its own, under the key 1.
+  Bucket              zero_    = {};
+  // Either the table was allocated, or the whole snapshot is mapped.
+  void*               map_     = nullptr;
+  size_t              mapped_  = 0;
+};
+
+}
@@ -0,0 +1,126 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "irreducible.h"
+#include "bytes.h"
+
+#include <bit>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace satz::gf2::native {
+
+namespace {
+
+// Interleaves the bits of `x` with zeros, i.e. squares it as a polynomial.
+uint64_t spread (uint32_t x) {
+  uint64_t v = x;
+  v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+  v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+  v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  v = (v | (v << 2)) & 0x3333333333333333ULL;
+  v = (v | (v << 1)) & 0x5555555555555555ULL;
+  return v;
+}
+
+poly_type square (uint64_t a) {
+  return (poly_type(spread(uint32_t(a >> 32))) << 64) | spread(uint32_t(a));
+}
+
+// Reduces `a` modulo `p` of degree `n`.
+poly_type mod (poly_type a, poly_type p, int n) {
+  for (int i = degree(a); i >= n; --i) {
+    if ((a >> i) & 0x1) a ^= p << (i - n);
+  }
+  return a;
+}
+
+poly_type gcd (poly_type a, poly_type b) {
+  while (b) {
+    a = mod(a, b, degree(b));
+    std::swap(a, b);
+  }
+  return a;
+}
+
+}
+
+int degree (poly_type p) {
+  auto hi = uint64_t(p >> 64);
+  auto lo = uint64_t(p);
+  if (hi) return 127 - std::countl_zero(hi);
+  if (lo) return 63 - std::countl_zero(lo);
+  return -1;
+}
+
+bool is_irreducible (poly_type p) {
+  const int n = degree(p);
+  Expects(n <= 64);
+
+  if (n <= 0) return false;
+  if (n == 1) return true;
+
+  // Cheap rejections: divisible by $x$, or by $x + 1$.
+  if (!(p & 0x1)) return false;
+  auto terms = std::popcount(uint64_t(p)) + std::popcount(uint64_t(p >> 64));
+  if (terms % 2 == 0) return false;
+
+  // `n / q` for every prime `q` dividing `n`
+  int cofactors[8];
+  int count = 0;
+  for (int q = 2, m = n; m > 1; ++q) {
+    if (m % q) continue;
+    cofactors[count++] = n / q;
+    while (m % q == 0) m /= q;
+  }
+
+  const poly_type x = 2;
+  poly_type       r = x; // $x^{2^i} mod p$
+  for (int i = 1; i <= n; ++i) {
+    r = mod(square(uint64_t(r)), p, n);
+    for (int j = 0; j < count; ++j) {
+      if (cofactors[j] == i && gcd(p, r ^ x) != 1) return false;
+    }
+  }
+  return r == x;
+}
+
+namespace {
+
+template <typename Random>
+poly_type search_irreducible (int degree, Random random) {
+  Expects(degree > 0 && degree <= 64);
+
+  // See `v2::Polynomial::make_irreducible` for the number of trials. The
+  // constant term is forced, as every irreducible polynomial of degree
+  // above one has it.
+  const uint64_t mask = degree == 64 ? ~uint64_t(0)
+                                     : (uint64_t(1) << degree) - 1;
+  int magic_number = 15;
+  auto trials = degree * magic_number;
+  while (trials-- > 0) {
+    auto p = (poly_type(1) << degree) | (random() & mask) | 0x1;
+    if (is_irreducible(p)) return p;
+  }
+
+  throw std::runtime_error("fail to obtain an irreducible polynomial");
+}
+
+}
+
+poly_type make_irreducible (int degree) {
+  return search_irreducible(degree, [] () {
+    return bytes::from_bytes<uint64_t>(bytes::make_random_bytes(8));
+  });
+}
+
+poly_type make_irreducible (int degree, uint64_t seed) {
+  // The output of `std::mt19937_64` is fixed by the standard.
+  std::mt19937_64 engine(seed);
+  return search_irreducible(degree, std::ref(engine));
+}
+
+}
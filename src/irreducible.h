@@ -0,0 +1,47 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace satz::gf2::native {
+
+/**
+ * @brief Polynomial over GF(2) of degree at most 64, with the coefficient
+ *    of $x^n$ in bit `n`.
+ */
+using poly_type = unsigned __int128;
+
+/**
+ * @brief Returns the degree of `p`, or -1 if `p` is zero.
+ */
+int degree (poly_type p);
+
+/**
+ * @brief Given a polynomial p over GF(2) return whether it is irreducible
+ *    with Rabin's test: $x^{2^n} \equiv x \pmod p$, where n is the degree
+ *    of p, and $gcd(x^{2^{n/q}} - x, p) = 1$ for every prime q dividing n.
+ * @param p polynomial over GF(2)
+ * @pre the degree of p is at most 64
+ * @return true if p is irreducible.
+ */
+bool is_irreducible (poly_type p);
+
+/**
+ * @brief Returns a random irreducible polynomial of the given degree.
+ * @pre 0 < degree <= 64
+ */
+poly_type make_irreducible (int degree);
+
+/**
+ * @brief Returns an irreducible polynomial of the given degree drawn from a
+ *    pseudo-random sequence, i.e. the same one for the same seed on every
+ *    platform.
+ * @pre 0 < degree <= 64
+ */
+poly_type make_irreducible (int degree, uint64_t seed);
+
+}
@@ -0,0 +1,141 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "kernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace satz::rabin::detail {
+
+#if defined(__x86_64__)
+
+namespace {
+
+// Returns the shuffle that turns 16 bytes of elements of `element` bytes,
+// stored least significant byte first, into a 128-bit polynomial whose
+// leading coefficient is the most significant bit of the first element.
+__attribute__((target("pclmul,ssse3")))
+inline __m128i block_order (size_t element) {
+  const auto e = int(element);
+  alignas(16) int8_t order[16];
+  for (int r = 0; r < 16; ++r) {
+    // byte `r` of the polynomial is byte `15 - r` of the stream
+    const int s = 15 - r;
+    order[r] = int8_t(s / e * e + (e - 1 - s % e));
+  }
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(order));
+}
+
+// Loads 16 bytes as a 128-bit polynomial, in the order given by
+// `block_order`.
+__attribute__((target("pclmul,ssse3")))
+inline __m128i load_block (const uint8_t* p, __m128i order) {
+  auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm_shuffle_epi8(x, order);
+}
+
+// Given `k` holding $x^e mod p$ in its low half and $x^{e+64} mod p$ in
+// its high half, returns a 128-bit polynomial congruent to $a \cdot x^e$.
+__attribute__((target("pclmul,ssse3")))
+inline __m128i fold (__m128i a, __m128i k) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(a, k, 0x00),
+                       _mm_clmulepi64_si128(a, k, 0x11));
+}
+
+__attribute__((target("pclmul,ssse3")))
+inline uint64_t clmul_lo (uint64_t a, uint64_t b) {
+  auto r = _mm_clmulepi64_si128(_mm_cvtsi64_si128(int64_t(a)),
+                                _mm_cvtsi64_si128(int64_t(b)), 0x00);
+  return uint64_t(_mm_cvtsi128_si64(r));
+}
+
+__attribute__((target("pclmul,ssse3")))
+inline uint64_t clmul_hi (uint64_t a, uint64_t b) {
+  auto r = _mm_clmulepi64_si128(_mm_cvtsi64_si128(int64_t(a)),
+                                _mm_cvtsi64_si128(int64_t(b)), 0x00);
+  return uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(r, r)));
+}
+
+}
+
+__attribute__((target("pclmul,ssse3")))
+Fingerprint fold_clmul (Fingerprint fp, const uint8_t* p, size_t n,
+                        size_t element,
+                        const Fingerprint* lookup,
+                        const Fingerprint* constants,
+                        Fingerprint m) {
+
+  const __m128i order = block_order(element);
+  const auto k = [constants] (int j) {
+    return _mm_set_epi64x(int64_t(constants[j - 1]),
+                          int64_t(constants[j - 2]));
+  };
+  const __m128i k128 = k(2);
+  const __m128i k256 = k(4);
+  const __m128i k384 = k(6);
+  const __m128i k512 = k(8);
+
+  // The accumulator is an unreduced polynomial of degree below 128 that is
+  // congruent to the fingerprint of the bytes consumed so far.
+  __m128i acc = _mm_cvtsi64_si128(int64_t(fp));
+  size_t  i   = 0;
+
+  // Four independent lanes, 64 bytes apart, hide the latency of the
+  // multiplications. They are merged back once the input runs short.
+  if (n >= 64) {
+    __m128i a0 = _mm_xor_si128(fold(acc, k128), load_block(p, order));
+    __m128i a1 = load_block(p + 16, order);
+    __m128i a2 = load_block(p + 32, order);
+    __m128i a3 = load_block(p + 48, order);
+    for (i = 64; i + 64 <= n; i += 64) {
+      a0 = _mm_xor_si128(fold(a0, k512), load_block(p + i, order));
+      a1 = _mm_xor_si128(fold(a1, k512), load_block(p + i + 16, order));
+      a2 = _mm_xor_si128(fold(a2, k512), load_block(p + i + 32, order));
+      a3 = _mm_xor_si128(fold(a3, k512), load_block(p + i + 48, order));
+    }
+    acc = _mm_xor_si128(_mm_xor_si128(fold(a0, k384), fold(a1, k256)),
+                        _mm_xor_si128(fold(a2, k128), a3));
+  }
+
+  for (; i + 16 <= n; i += 16) {
+    acc = _mm_xor_si128(fold(acc, k128), load_block(p + i, order));
+  }
+
+  // Barrett reduction of the accumulator modulo $p$.
+  auto hi = uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+  auto lo = uint64_t(_mm_cvtsi128_si64(acc));
+  auto q  = hi ^ clmul_hi(hi, constants[8]);
+  fp = lo ^ clmul_lo(q, m);
+
+  for (; i < n; i += element) {
+    for (size_t j = element; j-- > 0;) {
+      fp = (fp << 8 | p[i + j]) ^ lookup[fp >> 56];
+    }
+  }
+  return fp;
+}
+
+#else
+
+Fingerprint fold_clmul (Fingerprint fp, const uint8_t* p, size_t n,
+                        size_t element,
+                        const Fingerprint* lookup,
+                        const Fingerprint*,
+                        Fingerprint) {
+  constexpr bool little = std::endian::native == std::endian::little;
+  for (size_t i = 0; i < n; i += element) {
+    for (size_t j = 0; j < element; ++j) {
+      const uint8_t b = p[i + (little ? element - 1 - j : j)];
+      fp = (fp << 8 | b) ^ lookup[fp >> 56];
+    }
+  }
+  return fp;
+}
+
+#endif
+
+}
@@ -0,0 +1,145 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "measure.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace satz {
+
+namespace {
+
+constexpr size_t event_count = 4;
+
+// The member of `Counters` of each event.
+constexpr std::optional<double> Counters::* fields[event_count] = {
+    &Counters::cycles,
+    &Counters::instructions,
+    &Counters::l1d_misses,
+    &Counters::branch_misses,
+};
+
+#if defined(__linux__)
+
+// Opens an event of the calling thread, disabled, in the group of `leader`
+// or as a leader if it is negative. Returns -1 on failure.
+int open_event (uint32_t type, uint64_t config, int leader) {
+  perf_event_attr attr{};
+  attr.size           = sizeof(attr);
+  attr.type           = type;
+  attr.config         = config;
+  attr.disabled       = leader < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return int(::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+}
+
+#endif
+
+// Returns the `q`-quantile of `v` by the nearest-rank method.
+double quantile (std::vector<double> v, double q) {
+  const auto rank = size_t(std::ceil(q * double(v.size())));
+  const auto k    = std::clamp<size_t>(rank, 1, v.size()) - 1;
+  std::nth_element(v.begin(), v.begin() + k, v.end());
+  return v[k];
+}
+
+}
+
+PerfCounters::PerfCounters () {
+#if defined(__linux__)
+  constexpr std::pair<uint32_t, uint64_t> events[event_count] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                           | PERF_COUNT_HW_CACHE_OP_READ << 8
+                           | PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+
+  // One group, so that the events are counted over the same instructions.
+  for (size_t i = 0; i < event_count; ++i) {
+    fds_[i] = open_event(events[i].first, events[i].second, leader_);
+    if (leader_ < 0) leader_ = fds_[i];
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters () {
+#if defined(__linux__)
+  for (int fd : fds_) {
+    if (fd >= 0) ::close(fd);
+  }
+#endif
+}
+
+void PerfCounters::start () {
+#if defined(__linux__)
+  if (leader_ < 0) return;
+  ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+Counters PerfCounters::stop () {
+  Counters ret;
+#if defined(__linux__)
+  if (leader_ < 0) return ret;
+  ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  // number of events, time enabled, time running, then the counts in the
+  // order in which the events were opened
+  uint64_t buffer[3 + event_count];
+  if (::read(leader_, buffer, sizeof(buffer)) < 0) return ret;
+  const uint64_t enabled = buffer[1], running = buffer[2];
+  if (running == 0) return ret;
+
+  const double scale = double(enabled) / double(running);
+  size_t       j     = 0;
+  for (size_t i = 0; i < event_count; ++i) {
+    if (fds_[i] < 0) continue;
+    if (j == buffer[0]) break;
+    ret.*fields[i] = double(buffer[3 + j++]) * scale;
+  }
+#endif
+  return ret;
+}
+
+Statistics measure::Sampler::statistics () {
+  Statistics ret;
+  ret.samples    = times_.size();
+  ret.iterations = iterations_;
+  ret.bytes      = bytes_;
+  if (times_.empty()) return ret;
+
+  const auto n = double(iterations_);
+  ret.min    = *std::min_element(times_.begin(), times_.end()) / n;
+  ret.median = quantile(times_, 0.5) / n;
+  ret.p99    = quantile(times_, 0.99) / n;
+
+  for (auto field : fields) {
+    std::vector<double> counts;
+    for (const auto& sample : samples_) {
+      if (sample.*field) counts.push_back(*(sample.*field));
+    }
+    // an event counted in some samples only is not reliable
+    if (!counts.empty() && counts.size() == samples_.size()) {
+      ret.counters.*field = quantile(counts, 0.5) / n;
+    }
+  }
+  return ret;
+}
+
+}
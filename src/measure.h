@@ -5,10 +5,102 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
 
 namespace satz {
 
+/**
+ * @brief Hardware event counts, each empty if the event could not be
+ *    counted.
+ */
+struct Counters {
+  std::optional<double> cycles;
+  std::optional<double> instructions;
+  std::optional<double> l1d_misses;    // level 1 data cache read misses
+  std::optional<double> branch_misses;
+};
+
+/**
+ * @brief Counts hardware events of the calling thread, in user space, with
+ *    `perf_event_open` on Linux.
+ *
+ *    Events the kernel or the processor does not provide, or which the
+ *    process may not count (see `/proc/sys/kernel/perf_event_paranoid`),
+ *    are left out, as are all events on other systems. Threads started by
+ *    the measured code are not counted.
+ */
+class PerfCounters {
+public:
+  PerfCounters ();
+  ~PerfCounters ();
+
+  PerfCounters (const PerfCounters&) = delete;
+  PerfCounters& operator = (const PerfCounters&) = delete;
+
+  /**
+   * @brief Returns whether any event can be counted.
+   */
+  [[nodiscard]] bool available () const {return leader_ >= 0;}
+
+  /**
+   * @brief Resets the counts and starts counting.
+   */
+  void start ();
+
+  /**
+   * @brief Stops counting and returns the counts since `start`, scaled up
+   *    if the kernel multiplexed the counters.
+   */
+  Counters stop ();
+
+private:
+  int leader_ = -1;
+  int fds_[4] = {-1, -1, -1, -1}; // in the order of the `Counters` fields
+};
+
+/**
+ * @brief Summary of repeated measurements of a function, per call.
+ */
+struct Statistics {
+  uint64_t samples    = 0; // timed samples
+  uint64_t iterations = 0; // calls per sample
+  uint64_t bytes      = 0; // bytes processed per call, if given
+
+  // nanoseconds per call over the samples
+  double min    = 0;
+  double median = 0;
+  double p99    = 0;
+
+  // medians over the samples of the events per call
+  Counters counters;
+
+  [[nodiscard]] double ns_per_byte () const {return median / double(bytes);}
+
+  [[nodiscard]] double gb_per_s () const {return double(bytes) / median;}
+
+  [[nodiscard]] std::optional<double> cycles_per_byte () const {
+    if (!counters.cycles) return {};
+    return *counters.cycles / double(bytes);
+  }
+};
+
+/**
+ * @brief How long `measure::repeat` measures.
+ */
+struct RepeatOptions {
+  // least total time of the samples
+  std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+  // least number of samples
+  uint64_t min_samples = 5;
+  // number of samples aimed at in `min_time`, which sets how many calls
+  // make up one sample
+  uint64_t target_samples = 100;
+};
+
 struct measure {
 
   template<typename F, typename ...Args>
@@ -29,16 +121,90 @@ struct measure {
     return elapsed_time<nanoseconds>(f, std::forward<Args>(args)...);
   }
 
+  /**
+   * @brief Calls `f()` repeatedly and returns the time and hardware events
+   *    per call.
+   *
+   *    Calls are timed in samples of as many calls as make a sample last
+   *    about `min_time / target_samples`, so that fast functions are not
+   *    swamped by the cost of reading the clock and the counters; the
+   *    calibration doubles as a warm-up. Samples are taken until both
+   *    `min_time` and `min_samples` are reached.
+   *
+   * @param bytes the bytes processed per call, for the per-byte figures
+   */
+  template<typename F>
+  static Statistics repeat (F f,
+                            uint64_t bytes = 0,
+                            const RepeatOptions& options = {}) {
+    using namespace std::chrono;
+    const auto target = options.min_time / std::max<uint64_t>(
+        options.target_samples, 1);
+
+    uint64_t iterations = 1;
+    for (;;) {
+      const auto start = steady_clock::now();
+      for (uint64_t i = 0; i < iterations; ++i) f();
+      const auto elapsed = steady_clock::now() - start;
+      if (elapsed >= target || iterations >= (uint64_t(1) << 40)) break;
+      // aim a little past the target, so as not to stop just short of it
+      const auto ns = std::max<int64_t>(
+          duration_cast<nanoseconds>(elapsed).count(), 1);
+      iterations = std::clamp<uint64_t>(
+          uint64_t(double(iterations) * 1.4 * double(target.count()) /
+                   double(ns)),
+          iterations + 1, iterations * 10);
+    }
+
+    Sampler     sampler(iterations, bytes);
+    nanoseconds total{0};
+    while (total < options.min_time
+           || sampler.size() < options.min_samples) {
+      sampler.start();
+      const auto start = steady_clock::now();
+      for (uint64_t i = 0; i < iterations; ++i) f();
+      const auto elapsed = steady_clock::now() - start;
+      sampler.stop(elapsed);
+      total += elapsed;
+    }
+    return sampler.statistics();
+  }
+
 private:
   template<typename U, typename F, typename ...Args>
   static typename U::rep elapsed_time (F f, Args&& ... args) {
     using namespace std::chrono;
-    auto start = system_clock::now();
+    auto start = steady_clock::now();
     f(std::forward<Args>(args)...);
-    auto stop = system_clock::now();
+    auto stop = steady_clock::now();
     return duration_cast<U>(stop - start).count();
   }
+
+  // Collects the samples of `repeat`.
+  class Sampler {
+  public:
+    Sampler (uint64_t iterations, uint64_t bytes)
+        : iterations_(iterations), bytes_(bytes) { }
+
+    [[nodiscard]] uint64_t size () const {return times_.size();}
+
+    void start () {counters_.start();}
+
+    void stop (std::chrono::nanoseconds elapsed) {
+      // counters first, so that they leave out the bookkeeping
+      samples_.push_back(counters_.stop());
+      times_.push_back(double(elapsed.count()));
+    }
+
+    [[nodiscard]] Statistics statistics ();
+
+  private:
+    uint64_t              iterations_;
+    uint64_t              bytes_;
+    PerfCounters          counters_;
+    std::vector<double>   times_;
+    std::vector<Counters> samples_;
+  };
 };
 
 }
-
@@ -0,0 +1,55 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "parallel.h"
+
+#include <vector>
+
+namespace satz::rabin {
+
+namespace {
+
+// Segments shorter than this cost more to schedule than to fingerprint.
+constexpr size_t min_segment_size = 256 * 1024;
+
+}
+
+Fingerprint parallel_fingerprint (
+    const FingerprintGenerator& fg,
+    Fingerprint fp,
+    gsl::span<const uint8_t> bytes,
+    unsigned threads) {
+
+  const size_t n = bytes.size();
+  const size_t k = std::max<size_t>(
+      1, std::min<size_t>(threads, n / min_segment_size));
+
+  const uint8_t* p = bytes.data();
+  if (k == 1) return fg(fp, p, p + n);
+
+  // Segment `i` covers `[bounds[i], bounds[i+1])`.
+  std::vector<size_t> bounds(k + 1);
+  for (size_t i = 0; i <= k; ++i) bounds[i] = n / k * i;
+  bounds[k] = n;
+
+  std::vector<Fingerprint> partial(k, 0);
+  std::vector<std::thread> workers;
+  workers.reserve(k - 1);
+  for (size_t i = 1; i < k; ++i) {
+    workers.emplace_back([&, i] () {
+      partial[i] = fg(Fingerprint(0), p + bounds[i], p + bounds[i + 1]);
+    });
+  }
+  partial[0] = fg(fp, p + bounds[0], p + bounds[1]);
+  for (auto& w : workers) w.join();
+
+  Fingerprint ret = partial[0];
+  for (size_t i = 1; i < k; ++i) {
+    ret = fg.combine(ret, partial[i], bounds[i + 1] - bounds[i]);
+  }
+  return ret;
+}
+
+}
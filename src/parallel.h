@@ -0,0 +1,31 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <thread>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Computes `fg(fp, bytes.begin(), bytes.end())` on several threads.
+ *
+ *    The bytes are split into one segment per thread. Each segment is
+ *    fingerprinted from zero, and the partial results are stitched together
+ *    with `FingerprintGenerator::combine`. Inputs too short to be worth
+ *    splitting are fingerprinted on the calling thread.
+ *
+ * @param threads number of threads, including the calling one
+ */
+Fingerprint parallel_fingerprint (
+    const FingerprintGenerator& fg,
+    Fingerprint fp,
+    gsl::span<const uint8_t> bytes,
+    unsigned threads = std::thread::hardware_concurrency());
+
+}
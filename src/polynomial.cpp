@@ -5,6 +5,7 @@
 
 #include "polynomial.h"
 #include "bytes.h"
+#include "dense_polynomial.h"
 
 #include <boost/lexical_cast.hpp>
 #include <experimental/iterator>
@@ -186,6 +187,23 @@ Polynomial operator - (const Polynomial& lhs, const Polynomial& rhs) {
   return lhs ^ rhs;
 }
 
+// Whether the word-backed representation multiplies or reduces faster
+// than walking the nonzero terms, which is so unless the operands are
+// sparse enough that the terms are fewer than the words.
+static bool dense_pays (const Polynomial& lhs, const Polynomial& rhs) {
+  return int64_t(lhs.nnz()) * rhs.nnz() > lhs.degree() + rhs.degree();
+}
+
+static v3::Polynomial to_dense (const Polynomial& p) {
+  auto bytes = p.to_bytes();
+  return v3::Polynomial::from_bytes(bytes);
+}
+
+static Polynomial from_dense (const v3::Polynomial& p) {
+  auto bytes = p.to_bytes();
+  return Polynomial::from_bytes(bytes);
+}
+
 template<typename T, typename N>
 static void flip (std::vector<T>& bytes, N n) {
   bytes[n / 8] ^= (1 << (n % 8));
@@ -193,6 +211,7 @@ static void flip (std::vector<T>& bytes, N n) {
 
 Polynomial operator * (const Polynomial& lhs, const Polynomial& rhs) {
   if (lhs.degree() == 0 || rhs.degree() == 0) return Polynomial{};
+  if (dense_pays(lhs, rhs)) return from_dense(to_dense(lhs) * to_dense(rhs));
 
   auto degree_sum = lhs.degree() + rhs.degree();
   std::vector<uint8_t> bytes(degree_sum / 8 + 1, 0);
@@ -229,11 +248,14 @@ Polynomial Polynomial::operator >> (Polynomial::int_type n) const {
 
 Polynomial operator % (const Polynomial& lhs, const Polynomial& rhs) {
 
-  Polynomial ret{lhs};
+  Polynomial ret(lhs);
 
   using N = Polynomial::int_type;
   const N dl = lhs.degree();
   const N dr = rhs.degree();
+  if (dl >= dr && dr >= 0 && dense_pays(lhs, rhs)) {
+    return from_dense(to_dense(lhs) % to_dense(rhs));
+  }
 
   if (dl >= dr) {
     N i = dl - dr;
@@ -0,0 +1,118 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "pool.h"
+
+#include <utility>
+#include <gsl/gsl>
+
+namespace satz::rabin {
+
+namespace {
+
+// The pool and the index of the worker running on this thread, if any.
+thread_local const ThreadPool* current_pool  = nullptr;
+thread_local unsigned          current_index = 0;
+
+}
+
+ThreadPool::ThreadPool (unsigned threads) {
+  Expects(threads > 0);
+
+  queues_.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  workers_.reserve(threads);
+  for (unsigned i = 0; i < threads; ++i) {
+    workers_.emplace_back([this, i] () {run(i);});
+  }
+}
+
+ThreadPool::~ThreadPool () {
+  {
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] () {return pending_.load() == 0;});
+    stop_ = true;
+  }
+  work_.notify_all();
+  for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::submit (Task task) {
+  const unsigned i = current_pool == this ? current_index
+                                          : next_++ % size();
+  pending_.fetch_add(1);
+  {
+    std::lock_guard lock(queues_[i]->mutex);
+    queues_[i]->tasks.push_back(std::move(task));
+  }
+  queued_.fetch_add(1);
+
+  // Sleeping workers check `queued_` under the lock, so that taking it
+  // here, however briefly, ensures that the notification is not lost.
+  { std::lock_guard lock(mutex_); }
+  work_.notify_one();
+}
+
+void ThreadPool::wait () {
+  Expects(current_pool != this);
+
+  std::unique_lock lock(mutex_);
+  done_.wait(lock, [this] () {return pending_.load() == 0;});
+  if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+void ThreadPool::run (unsigned index) {
+  current_pool  = this;
+  current_index = index;
+
+  Task task;
+  while (true) {
+    if (pop(index, task) || steal(index, task)) {
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+      }
+      task = nullptr;
+      if (pending_.fetch_sub(1) == 1) {
+        { std::lock_guard lock(mutex_); }
+        done_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock lock(mutex_);
+    work_.wait(lock, [this] () {return stop_ || queued_.load() > 0;});
+    if (stop_ && queued_.load() == 0) return;
+  }
+}
+
+bool ThreadPool::pop (unsigned index, Task& task) {
+  Queue& q = *queues_[index];
+  std::lock_guard lock(q.mutex);
+  if (q.tasks.empty()) return false;
+  task = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  queued_.fetch_sub(1);
+  return true;
+}
+
+bool ThreadPool::steal (unsigned index, Task& task) {
+  for (unsigned k = 1; k < size(); ++k) {
+    Queue& q = *queues_[(index + k) % size()];
+    std::lock_guard lock(q.mutex);
+    if (q.tasks.empty()) continue;
+    task = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    queued_.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+}
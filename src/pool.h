@@ -0,0 +1,90 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace satz::rabin {
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ *    Every worker has a deque of tasks. A task submitted by a worker goes
+ *    to the back of its own deque, and a worker takes its next task from
+ *    the back of its own deque, so that a task split into subtasks is
+ *    carried on by the worker that split it while its data is in cache.
+ *    An idle worker steals from the front of the others' deques, where the
+ *    oldest and usually largest tasks are. Tasks submitted from outside
+ *    the pool are spread over the deques in turn.
+ */
+class ThreadPool {
+public:
+  using Task = std::function<void ()>;
+
+  /**
+   * @pre threads > 0
+   */
+  explicit ThreadPool (unsigned threads = std::thread::hardware_concurrency());
+
+  /**
+   * @brief Waits for the tasks to finish, ignoring their exceptions, and
+   *    stops the workers.
+   */
+  ~ThreadPool ();
+
+  ThreadPool (const ThreadPool&) = delete;
+  ThreadPool& operator = (const ThreadPool&) = delete;
+
+  [[nodiscard]] unsigned size () const {return unsigned(workers_.size());}
+
+  /**
+   * @brief Schedules a task; may be called from any thread, including the
+   *    pool's own workers.
+   */
+  void submit (Task task);
+
+  /**
+   * @brief Waits until every submitted task, including those submitted by
+   *    other tasks meanwhile, has finished.
+   * @throw the first exception thrown by a task since the last call, after
+   *    all tasks have finished
+   */
+  void wait ();
+
+private:
+  struct Queue {
+    std::mutex       mutex;
+    std::deque<Task> tasks;
+  };
+
+  void run (unsigned index);
+
+  bool pop (unsigned index, Task& task);
+
+  bool steal (unsigned index, Task& task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread>            workers_;
+  std::atomic<unsigned>               next_    = 0; // deque for outsiders
+  std::atomic<size_t>                 queued_  = 0; // tasks in the deques
+  std::atomic<size_t>                 pending_ = 0; // tasks not finished
+
+  std::mutex              mutex_; // guards the fields below and the waits
+  std::condition_variable work_;
+  std::condition_variable done_;
+  bool                    stop_ = false;
+  std::exception_ptr      error_;
+};
+
+}
@@ -0,0 +1,142 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+// Scans directory trees for duplicate content:
+//
+//    rabin-scan [options] PATH...
+//
+// Every regular file under the paths is split into content-defined chunks,
+// and the tool reports how many bytes remain once identical chunks are
+// stored once, and the groups of identical chunks that account for most of
+// the difference. Files that cannot be read are listed on the standard
+// error and left out.
+//
+// Options:
+//    --threads N         worker threads, one per core by default
+//    --segment-size B    split files larger than this, 64 MiB by default
+//    --min-size B        smallest chunk, 2 KiB by default
+//    --avg-size B        average chunk, 8 KiB by default
+//    --max-size B        largest chunk, 64 KiB by default
+//    --clusters N        duplicate clusters to list, 10 by default
+//    --seed S            seed of the fingerprint generator, 0 by default
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "scan.h"
+
+namespace {
+
+using namespace satz::rabin;
+
+[[noreturn]] void usage (const char* program) {
+  std::cerr << "usage: " << program << " [--threads N] [--segment-size B] "
+            << "[--min-size B] [--avg-size B] [--max-size B] "
+            << "[--clusters N] [--seed S] PATH...\n";
+  std::exit(2);
+}
+
+// Formats a byte count with a binary unit.
+std::string human (uint64_t bytes) {
+  const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB"};
+  double      value   = double(bytes);
+  int         unit    = 0;
+  while (value >= 1024 && unit < 5) {
+    value /= 1024;
+    ++unit;
+  }
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(unit ? 1 : 0) << value << " "
+      << units[unit];
+  return out.str();
+}
+
+}
+
+int main (int argc, char** argv) {
+  ScanConfig                         config;
+  std::vector<std::filesystem::path> roots;
+  if (config.threads == 0) config.threads = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    auto number = [&] () -> uint64_t {
+      if (i + 1 == argc) usage(argv[0]);
+      char* end = nullptr;
+      auto  ret = std::strtoull(argv[++i], &end, 0);
+      if (*end) usage(argv[0]);
+      return ret;
+    };
+    if (!std::strcmp(argv[i], "--threads")) {
+      config.threads = unsigned(std::max<uint64_t>(1, number()));
+    } else if (!std::strcmp(argv[i], "--segment-size")) {
+      config.segment_size = std::max<uint64_t>(1, number());
+    } else if (!std::strcmp(argv[i], "--min-size")) {
+      config.chunker.min_size = number();
+    } else if (!std::strcmp(argv[i], "--avg-size")) {
+      config.chunker.avg_size = number();
+    } else if (!std::strcmp(argv[i], "--max-size")) {
+      config.chunker.max_size = number();
+    } else if (!std::strcmp(argv[i], "--clusters")) {
+      config.max_clusters = number();
+    } else if (!std::strcmp(argv[i], "--seed")) {
+      config.seed = number();
+    } else if (argv[i][0] == '-' && argv[i][1]) {
+      usage(argv[0]);
+    } else {
+      roots.emplace_back(argv[i]);
+    }
+  }
+  const auto& chunking = config.chunker;
+  if (roots.empty() || chunking.min_size < chunking.window
+      || chunking.avg_size < chunking.min_size
+      || chunking.max_size < chunking.avg_size) {
+    usage(argv[0]);
+  }
+
+  const auto start   = std::chrono::steady_clock::now();
+  const auto report  = scan(roots, config);
+  const auto seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  for (const auto& e : report.errors) {
+    std::cerr << argv[0] << ": " << e.path.string() << ": " << e.what << "\n";
+  }
+
+  std::cout << "files          " << report.files << "\n"
+            << "bytes          " << human(report.bytes) << " ("
+            << report.bytes << ")\n"
+            << "chunks         " << report.chunks << "\n"
+            << "unique chunks  " << report.unique_chunks << "\n"
+            << "unique bytes   " << human(report.unique_bytes) << " ("
+            << report.unique_bytes << ")\n"
+            << "dedup ratio    " << std::fixed << std::setprecision(3)
+            << report.dedup_ratio() << "\n"
+            << "elapsed        " << std::setprecision(2) << seconds << " s, "
+            << double(report.bytes) / seconds / 1e9 << " GB/s\n";
+
+  if (!report.clusters.empty()) {
+    std::cout << "\nduplicate clusters, by bytes saved:\n";
+  }
+  for (const auto& c : report.clusters) {
+    std::cout << "  " << std::hex << std::setw(16) << std::setfill('0')
+              << c.fp << std::dec << std::setfill(' ') << "  "
+              << c.length << " bytes x " << c.copies << ", "
+              << human(c.saved()) << " saved\n";
+    for (const auto& l : c.locations) {
+      std::cout << "    " << l.path.string() << " @ " << l.offset << "\n";
+    }
+    if (c.locations.size() < c.copies) {
+      std::cout << "    ...\n";
+    }
+  }
+  return report.errors.empty() ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "reader.h"
+
+#include <cerrno>
+#include <new>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace satz::rabin {
+
+namespace {
+
+// Alignment of the buffers, and of their size, as O_DIRECT requires.
+constexpr size_t page = 4096;
+
+[[noreturn]] void throw_errno (const std::filesystem::path& path,
+                               const char* what) {
+  throw std::system_error(errno, std::generic_category(),
+                          std::string(what) + " " + path.string());
+}
+
+}
+
+AsyncReader::AsyncReader (const std::filesystem::path& path,
+                          ReaderConfig config)
+    : config_(config), path_(path), direct_(false) {
+  Expects(config.buffers > 0);
+  Expects(config.buffer_size > 0 && config.buffer_size % page == 0);
+
+  // Opened once, and O_DIRECT set afterwards: opening a pipe connects to
+  // its writer before O_DIRECT is refused, and opening it again would
+  // leave the writer with no reader in between.
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) throw_errno(path, "cannot open");
+#if defined(O_DIRECT)
+  struct stat st{};
+  if (config.direct && ::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) {
+    // file systems without O_DIRECT refuse it with EINVAL
+    const int flags = ::fcntl(fd_, F_GETFL);
+    direct_ = flags >= 0 && ::fcntl(fd_, F_SETFL, flags | O_DIRECT) == 0;
+  }
+#endif
+  if (!direct_) ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  memory_.reset(static_cast<uint8_t*>(
+      std::aligned_alloc(page, config.buffers * config.buffer_size)));
+  if (!memory_) {
+    ::close(fd_);
+    throw std::bad_alloc();
+  }
+  lengths_.resize(config.buffers);
+
+  thread_ = std::thread([this] () {run();});
+}
+
+AsyncReader::~AsyncReader () {
+  // Releases every buffer, so that the reader thread wakes up if it waits
+  // for one, and sees that it must stop.
+  stop_ = true;
+  consumed_.fetch_add(config_.buffers);
+  consumed_.notify_one();
+  thread_.join();
+  ::close(fd_);
+}
+
+gsl::span<const uint8_t> AsyncReader::next () {
+  if (end_) return {};
+  if (holding_) {
+    consumed_.fetch_add(1, std::memory_order_release);
+    consumed_.notify_one();
+    holding_ = false;
+  }
+
+  const uint64_t c = consumed_.load(std::memory_order_relaxed);
+  uint64_t       p = produced_.load(std::memory_order_acquire);
+  while (p == c) {
+    produced_.wait(p, std::memory_order_acquire);
+    p = produced_.load(std::memory_order_acquire);
+  }
+
+  const size_t slot = c % config_.buffers;
+  if (lengths_[slot] == 0) {
+    end_ = true;
+    if (error_) std::rethrow_exception(error_);
+    return {};
+  }
+  holding_ = true;
+  return {memory_.get() + slot * config_.buffer_size, lengths_[slot]};
+}
+
+void AsyncReader::run () {
+  for (uint64_t p = 0;; ++p) {
+    uint64_t c = consumed_.load(std::memory_order_acquire);
+    while (p - c == config_.buffers && !stop_) {
+      consumed_.wait(c, std::memory_order_acquire);
+      c = consumed_.load(std::memory_order_acquire);
+    }
+    if (stop_) return;
+
+    const size_t slot = p % config_.buffers;
+    size_t       n    = 0;
+    try {
+      n = fill(memory_.get() + slot * config_.buffer_size);
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    lengths_[slot] = n;
+    produced_.store(p + 1, std::memory_order_release);
+    produced_.notify_one();
+    if (n == 0) return;
+  }
+}
+
+size_t AsyncReader::fill (uint8_t* buffer) {
+  size_t n = 0;
+  while (n < config_.buffer_size) {
+    const size_t  want = config_.buffer_size - n;
+    const ssize_t r    = seekable_ ? ::pread(fd_, buffer + n, want,
+                                             off_t(offset_))
+                                   : ::read(fd_, buffer + n, want);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      if (errno == ESPIPE && seekable_) {
+        seekable_ = false;
+        continue;
+      }
+#if defined(O_DIRECT)
+      // Some file systems accept O_DIRECT but refuse the reads, and a
+      // short read leaves the offset unaligned: carry on through the cache.
+      if (errno == EINVAL && direct_) {
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_DIRECT);
+        direct_ = false;
+        continue;
+      }
+#endif
+      throw_errno(path_, "cannot read");
+    }
+    if (r == 0) break;
+    n       += size_t(r);
+    offset_ += uint64_t(r);
+  }
+  return n;
+}
+
+}
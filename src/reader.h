@@ -0,0 +1,118 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <gsl/gsl>
+
+namespace satz::rabin {
+
+/**
+ * @brief Parameters of `AsyncReader`.
+ */
+struct ReaderConfig {
+  // bytes per buffer, a multiple of 4096
+  size_t buffer_size = 4 * 1024 * 1024;
+  // buffers in the ring; one reads and hashes in turn, two or more overlap
+  // reading with hashing
+  size_t buffers     = 3;
+  // whether to bypass the page cache with O_DIRECT, where supported
+  bool   direct      = true;
+};
+
+/**
+ * @brief Reads a file on a thread of its own into a ring of page-aligned
+ *    buffers, ahead of the consumer, so that waiting on the device overlaps
+ *    with processing the data instead of adding to it.
+ *
+ *    The reader thread fills free buffers in order with `pread`, bypassing
+ *    the page cache with O_DIRECT where the file system supports it, and
+ *    falling back to cached reads where it does not, and to `read` for
+ *    pipes. The consumer is handed the buffers themselves, without copies:
+ *
+ *        AsyncReader reader(path);
+ *        for (auto b = reader.next(); !b.empty(); b = reader.next()) {
+ *          fp = fg(fp, b.begin(), b.end());
+ *        }
+ *
+ *    Only one thread may consume.
+ */
+class AsyncReader {
+public:
+  /**
+   * @pre config.buffers > 0, and config.buffer_size is a positive multiple
+   *    of 4096
+   * @throw std::system_error if the file cannot be opened
+   */
+  explicit AsyncReader (const std::filesystem::path& path,
+                        ReaderConfig config = {});
+
+  /**
+   * @brief Stops reading, and closes the file.
+   */
+  ~AsyncReader ();
+
+  AsyncReader (const AsyncReader&) = delete;
+  AsyncReader& operator = (const AsyncReader&) = delete;
+
+  /**
+   * @brief Returns the next block of the file, which stays valid until the
+   *    next call, or an empty span at the end of the file. Every block but
+   *    the last is a full buffer.
+   * @throw std::system_error if reading failed, once the blocks read
+   *    before the failure have been returned
+   */
+  gsl::span<const uint8_t> next ();
+
+  /**
+   * @brief Returns whether reads bypass the page cache.
+   */
+  [[nodiscard]] bool direct () const {
+    return direct_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Free {
+    void operator () (uint8_t* p) const {std::free(p);}
+  };
+
+  // Runs on the reader thread.
+  void run ();
+
+  // Fills `buffer` up to its size or the end of the file, and returns the
+  // number of bytes read.
+  size_t fill (uint8_t* buffer);
+
+  ReaderConfig                   config_;
+  std::filesystem::path          path_;
+  int                            fd_;
+  std::atomic<bool>              direct_;
+  bool                           seekable_ = true;
+  uint64_t                       offset_   = 0;
+  std::unique_ptr<uint8_t, Free> memory_;
+  std::vector<size_t>            lengths_; // bytes in each buffer
+
+  // Buffers filled and released so far, counting from the start of the
+  // file; the consumer owns those in between, and the reader thread fills
+  // the next one once fewer than `config_.buffers` are taken.
+  std::atomic<uint64_t> produced_ = 0;
+  std::atomic<uint64_t> consumed_ = 0;
+  std::atomic<bool>     stop_     = false;
+  std::exception_ptr    error_;            // published with the end
+  bool                  holding_  = false; // consumer holds a buffer
+  bool                  end_      = false; // consumer reached the end
+
+  std::thread thread_;
+};
+
+}
@@ -0,0 +1,42 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "rolling.h"
+
+namespace satz::rabin {
+
+RollingFingerprint::RollingFingerprint (FingerprintGenerator fg, size_t width)
+    : fg_(std::move(fg)), width_(width), pop_(256, 0) {
+
+  Expects(width_ > 0);
+
+  // Shift each bit of a byte past `width - 1` zero bytes; the table then
+  // follows from linearity.
+  Fingerprint basis[8];
+  for (int k = 0; k < 8; ++k) {
+    Fingerprint fp = Fingerprint(1) << k;
+    for (size_t i = 1; i < width_; ++i) fp = fg_.push(fp, 0);
+    basis[k] = fp;
+  }
+
+  for (unsigned int b = 1; b < 256; ++b) {
+    Fingerprint fp = 0;
+    for (int k = 0; k < 8; ++k) {
+      if ((b >> k) & 0x1) fp ^= basis[k];
+    }
+    pop_[b] = fp;
+  }
+}
+
+std::vector<Fingerprint> RollingFingerprint::roll (
+    gsl::span<const uint8_t> bytes) const {
+
+  std::vector<Fingerprint> ret;
+  if (bytes.size() >= width_) ret.reserve(bytes.size() - width_ + 1);
+  roll(bytes, std::back_inserter(ret));
+  return ret;
+}
+
+}
@@ -0,0 +1,102 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Fingerprints of a fixed-width window sliding over a byte stream.
+ *
+ *    The fingerprint of a window is the fingerprint of its bytes starting
+ *    from zero, so that it only depends on the content of the window. Both
+ *    appending a byte and dropping the oldest byte cost one table lookup:
+ *    the former through the lookup table of the generator, the latter
+ *    through a "pop" table precomputed for the width of the window.
+ */
+class RollingFingerprint {
+public:
+  /**
+   * @param fg fingerprint generator
+   * @param width number of bytes in a window
+   * @pre width > 0
+   */
+  RollingFingerprint (FingerprintGenerator fg, size_t width);
+
+  [[nodiscard]] size_t width () const {return width_;}
+
+  [[nodiscard]] const FingerprintGenerator& generator () const {return fg_;}
+
+  /**
+   * @brief Appends a byte to the window.
+   */
+  Fingerprint push (Fingerprint fp, uint8_t in) const {
+    return fg_.push(fp, in);
+  }
+
+  /**
+   * @brief Drops the oldest byte from a full window.
+   * @param fp fingerprint of a window of exactly `width()` bytes
+   * @param out the oldest byte of that window
+   * @return fingerprint of the remaining `width() - 1` bytes
+   */
+  Fingerprint pop (Fingerprint fp, uint8_t out) const {
+    return fp ^ pop_[out];
+  }
+
+  /**
+   * @brief Slides a full window by one byte.
+   */
+  Fingerprint roll (Fingerprint fp, uint8_t out, uint8_t in) const {
+    return push(pop(fp, out), in);
+  }
+
+  /**
+   * @brief Returns the fingerprint of the first `width()` bytes.
+   * @pre window.size() >= width()
+   */
+  Fingerprint operator () (gsl::span<const uint8_t> window) const {
+    Expects(window.size() >= width_);
+    return fg_(Fingerprint(0), window.data(), window.data() + width_);
+  }
+
+  /**
+   * @brief Writes the fingerprint of the window at every position of
+   *    `bytes`, i.e. `bytes.size() - width() + 1` values, or none if
+   *    `bytes` is shorter than a window.
+   * @return output iterator past the last written value
+   */
+  template <typename OutputIt>
+  OutputIt roll (gsl::span<const uint8_t> bytes, OutputIt out) const {
+    const size_t n = bytes.size();
+    if (n < width_) return out;
+
+    const uint8_t* p  = bytes.data();
+    Fingerprint    fp = (*this)(bytes);
+    *out++ = fp;
+    for (size_t i = width_; i < n; ++i) {
+      fp = roll(fp, p[i - width_], p[i]);
+      *out++ = fp;
+    }
+    return out;
+  }
+
+  [[nodiscard]] std::vector<Fingerprint> roll (
+      gsl::span<const uint8_t> bytes) const;
+
+private:
+  FingerprintGenerator fg_;
+  size_t               width_;
+  // `pop_[b]` is the contribution of byte `b` at the oldest position of
+  //    a window, i.e. $b \cdot x^{8(width-1)} mod p$.
+  std::vector<Fingerprint> pop_;
+};
+
+}
@@ -0,0 +1,340 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "scan.h"
+#include "index.h"
+#include "pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <system_error>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace satz::rabin {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Chunk {
+  Fingerprint fp;
+  uint64_t    offset;
+};
+
+// Chunks of a segment of a file. The first starts at the beginning of the
+// segment, which may not be a cut of the whole file, and the last one ends
+// at `end`, at or past the end of the segment.
+struct Segment {
+  std::vector<Chunk> chunks;
+  uint64_t           end = 0;
+};
+
+struct File {
+  fs::path           path;
+  uint64_t           size;
+  std::vector<Chunk> chunks;
+  std::string        error;
+};
+
+// A read-only mapping of a whole file.
+class Mapping {
+public:
+  explicit Mapping (const fs::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw_errno(path, "cannot open");
+
+    struct stat st{};
+    if (::fstat(fd, &st) < 0) {
+      ::close(fd);
+      throw_errno(path, "cannot stat");
+    }
+    size_ = size_t(st.st_size);
+    if (size_ > 0) {
+      void* map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED) {
+        ::close(fd);
+        throw_errno(path, "cannot map");
+      }
+      data_ = static_cast<const uint8_t*>(map);
+      ::madvise(map, size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+
+  Mapping (const Mapping&) = delete;
+  Mapping& operator = (const Mapping&) = delete;
+
+  ~Mapping () {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+  }
+
+  [[nodiscard]] const uint8_t* data () const {return data_;}
+
+  [[nodiscard]] size_t size () const {return size_;}
+
+private:
+  [[noreturn]] static void throw_errno (const fs::path& path,
+                                        const char* what) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::string(what) + " " + path.string());
+  }
+
+  const uint8_t* data_ = nullptr;
+  size_t         size_ = 0;
+};
+
+// Adds the regular files under `root` to `files`.
+void walk (const fs::path& root,
+           std::vector<File>& files,
+           std::vector<ScanReport::Error>& errors) {
+  std::error_code ec;
+  auto add = [&] (const fs::path& path, fs::file_status status) {
+    if (!fs::is_regular_file(status)) return;
+    const auto size = fs::file_size(path, ec);
+    if (ec) {
+      errors.push_back({path, ec.message()});
+    } else {
+      files.push_back({path, size, {}, {}});
+    }
+  };
+
+  const auto status = fs::symlink_status(root, ec);
+  if (ec) {
+    errors.push_back({root, ec.message()});
+    return;
+  }
+  if (!fs::is_directory(status)) {
+    add(root, status);
+    return;
+  }
+
+  fs::recursive_directory_iterator it(
+      root, fs::directory_options::skip_permission_denied, ec);
+  for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+    add(it->path(), it->symlink_status(ec));
+    ec.clear();
+  }
+  if (ec) errors.push_back({root, ec.message()});
+}
+
+class Scanner {
+public:
+  Scanner (const ScanConfig& config, size_t capacity)
+      : Scanner(config, capacity, FingerprintGenerator::create(config.seed)) {
+  }
+
+  void scan (std::vector<File>& files) {
+    for (File& file : files) {
+      pool_.submit([this, &file] () {
+        try {
+          scan_file(file);
+        } catch (const std::exception& e) {
+          file.error = e.what();
+        }
+      });
+    }
+    pool_.wait();
+  }
+
+  [[nodiscard]] const FingerprintIndex& index () const {return index_;}
+
+private:
+  Scanner (const ScanConfig& config,
+           size_t capacity,
+           std::pair<FingerprintGenerator, Fingerprint> generator)
+      : config_(config),
+        fg_(generator.first),
+        fp0_(generator.second),
+        chunker_(fg_, config.chunker),
+        index_(capacity),
+        pool_(config.threads) { }
+
+  // Fingerprints the chunk of `map` at `offset` and appends it, and returns
+  // its end.
+  uint64_t append_chunk (const Mapping& map,
+                         uint64_t offset,
+                         std::vector<Chunk>& out) const {
+    const uint8_t* p   = map.data() + offset;
+    const size_t   len = chunker_.next_cut({p, map.size() - offset});
+    out.push_back({fg_(fp0_, p, p + len), offset});
+    return offset + len;
+  }
+
+  // Chunks from `begin`, until a chunk ends at or past `end`.
+  Segment chunk_segment (const Mapping& map,
+                         uint64_t begin,
+                         uint64_t end) const {
+    Segment ret;
+    ret.chunks.reserve((end - begin) / config_.chunker.avg_size + 1);
+    ret.end = begin;
+    while (ret.end < end) ret.end = append_chunk(map, ret.end, ret.chunks);
+    return ret;
+  }
+
+  // Joins the chunks of consecutive segments into the chunks of the whole
+  // file. Where the last chunk of a segment ends inside the next segment,
+  // chunking carries on from there until it reaches a cut of that segment;
+  // from a common cut on, both find the same cuts.
+  std::vector<Chunk> stitch (const Mapping& map,
+                             std::vector<Segment>& segments) const {
+    std::vector<Chunk> ret = std::move(segments[0].chunks);
+    uint64_t           pos = segments[0].end;
+    for (size_t j = 1; j < segments.size(); ++j) {
+      const auto& chunks = segments[j].chunks;
+      size_t      k      = 0;
+      while (true) {
+        while (k < chunks.size() && chunks[k].offset < pos) ++k;
+        if (k == chunks.size()) break;
+        if (chunks[k].offset == pos) {
+          ret.insert(ret.end(), chunks.begin() + ptrdiff_t(k), chunks.end());
+          pos = segments[j].end;
+          break;
+        }
+        pos = append_chunk(map, pos, ret);
+      }
+    }
+    while (pos < map.size()) pos = append_chunk(map, pos, ret);
+    return ret;
+  }
+
+  // Counts the chunks of a file in the index. The scan stores no chunks,
+  // so the location of each entry is the length of its chunk instead,
+  // which the report reads back.
+  void insert (File& file, std::vector<Chunk> chunks) {
+    std::vector<Fingerprint> keys(chunks.size());
+    std::vector<uint64_t>    lengths(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      const uint64_t end = i + 1 < chunks.size() ? chunks[i + 1].offset
+                                                  : file.size;
+      keys[i]    = chunks[i].fp;
+      lengths[i] = end - chunks[i].offset;
+    }
+    std::vector<FingerprintIndex::Insertion> out(chunks.size());
+    index_.insert(keys, lengths, out);
+    file.chunks = std::move(chunks);
+  }
+
+  void scan_file (File& file) {
+    auto map = std::make_shared<const Mapping>(file.path);
+    // the size read when walking may be out of date
+    file.size = map->size();
+    if (file.size == 0) return;
+
+    const uint64_t n = (file.size + config_.segment_size - 1)
+                       / config_.segment_size;
+    if (n == 1) {
+      insert(file, chunk_segment(*map, 0, file.size).chunks);
+      return;
+    }
+
+    // The last segment to finish stitches them together. A segment that
+    // fails is never counted as finished, so the file is not stitched, and
+    // only the first failure is recorded.
+    struct Split {
+      std::vector<Segment> segments;
+      std::atomic<size_t>  remaining;
+      std::atomic<bool>    failed = false;
+    };
+    auto split = std::make_shared<Split>();
+    split->segments.resize(n);
+    split->remaining = n;
+
+    // Pushed last, the first segment is the first one this worker carries
+    // on with, while idle workers steal from the end of the file.
+    for (uint64_t j = n; j-- > 0;) {
+      pool_.submit([this, &file, map, split, j] () {
+        try {
+          const uint64_t begin = j * config_.segment_size;
+          const uint64_t end   = std::min(begin + config_.segment_size,
+                                          file.size);
+          split->segments[j] = chunk_segment(*map, begin, end);
+          if (split->remaining.fetch_sub(1) == 1) {
+            insert(file, stitch(*map, split->segments));
+          }
+        } catch (const std::exception& e) {
+          if (!split->failed.exchange(true)) file.error = e.what();
+        }
+      });
+    }
+  }
+
+  const ScanConfig&    config_;
+  FingerprintGenerator fg_;
+  Fingerprint          fp0_;
+  Chunker              chunker_;
+  FingerprintIndex     index_;
+  ThreadPool           pool_;
+};
+
+}
+
+ScanReport scan (gsl::span<const std::filesystem::path> roots,
+                 const ScanConfig& config) {
+  Expects(config.threads > 0 && config.segment_size > 0);
+
+  ScanReport        ret;
+  std::vector<File> files;
+  for (const auto& root : roots) walk(root, files, ret.errors);
+
+  // At most one chunk per `min_size` bytes, and per file.
+  size_t capacity = 1;
+  for (const File& file : files) {
+    capacity += file.size / config.chunker.min_size + 1;
+  }
+
+  Scanner scanner(config, capacity);
+  scanner.scan(files);
+  const auto& index = scanner.index();
+
+  for (const File& file : files) {
+    if (!file.error.empty()) {
+      ret.errors.push_back({file.path, file.error});
+      continue;
+    }
+    ++ret.files;
+    ret.bytes  += file.size;
+    ret.chunks += file.chunks.size();
+  }
+  ret.unique_chunks = index.size();
+
+  std::vector<ScanReport::Cluster> clusters;
+  index.for_each([&] (Fingerprint fp, FingerprintIndex::Entry e) {
+    const uint64_t length = e.location; // see `Scanner::insert`
+    ret.unique_bytes += length;
+    if (e.refcount > 1) clusters.push_back({fp, length, e.refcount, {}});
+  });
+
+  const size_t k = std::min(config.max_clusters, clusters.size());
+  std::partial_sort(clusters.begin(), clusters.begin() + ptrdiff_t(k),
+                    clusters.end(),
+                    [] (const auto& a, const auto& b) {
+                      return a.saved() > b.saved();
+                    });
+  clusters.resize(k);
+
+  std::unordered_map<Fingerprint, ScanReport::Cluster*> by_fp;
+  for (auto& c : clusters) by_fp[c.fp] = &c;
+  for (const File& file : files) {
+    if (!file.error.empty()) continue;
+    for (const Chunk& chunk : file.chunks) {
+      auto it = by_fp.find(chunk.fp);
+      if (it == by_fp.end()) continue;
+      auto& locations = it->second->locations;
+      if (locations.size() < config.max_locations) {
+        locations.push_back({file.path, chunk.offset});
+      }
+    }
+  }
+  ret.clusters = std::move(clusters);
+  return ret;
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gsl/gsl>
+#include "chunker.h"
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Parameters of `scan`.
+ */
+struct ScanConfig {
+  ChunkerConfig chunker;
+  // files larger than this are split into segments of this size, chunked
+  // in parallel
+  uint64_t segment_size = 64 * 1024 * 1024;
+  unsigned threads      = std::thread::hardware_concurrency();
+  // seed of the generator, so that runs are comparable
+  uint64_t seed         = 0;
+  // largest clusters reported, and locations reported per cluster
+  size_t   max_clusters  = 10;
+  size_t   max_locations = 8;
+};
+
+/**
+ * @brief Duplicate content found by `scan`.
+ */
+struct ScanReport {
+  struct Location {
+    std::filesystem::path path;
+    uint64_t              offset;
+  };
+
+  // Identical chunks, found `copies` times.
+  struct Cluster {
+    Fingerprint           fp;
+    uint64_t              length;
+    uint64_t              copies;
+    std::vector<Location> locations; // the first few, in no set order
+
+    [[nodiscard]] uint64_t saved () const {return length * (copies - 1);}
+  };
+
+  struct Error {
+    std::filesystem::path path;
+    std::string           what;
+  };
+
+  uint64_t files         = 0; // regular files read
+  uint64_t bytes         = 0;
+  uint64_t chunks        = 0;
+  uint64_t unique_chunks = 0;
+  uint64_t unique_bytes  = 0;
+
+  // the clusters that save the most bytes, largest first
+  std::vector<Cluster> clusters;
+  // files or directories that could not be read, and were left out
+  std::vector<Error>   errors;
+
+  /**
+   * @brief Returns the bytes read over the unique bytes.
+   */
+  [[nodiscard]] double dedup_ratio () const {
+    return unique_bytes ? double(bytes) / double(unique_bytes) : 1.0;
+  }
+};
+
+/**
+ * @brief Chunks and fingerprints every regular file under the given
+ *    paths, and measures how much of their content is duplicated.
+ *
+ *    Files are split into content-defined chunks with one generator, and
+ *    the chunks are counted in a `FingerprintIndex`. Files, and segments
+ *    of large files, are spread over a work-stealing `ThreadPool`, so that
+ *    one huge file keeps all threads busy. The chunks of neighbouring
+ *    segments are stitched together at the first cut they share, so the
+ *    report does not depend on the number of threads or the segment size.
+ *
+ *    Symbolic links are not followed. Memory use is about 16 bytes per
+ *    chunk, plus an index sized for the worst case of one chunk per
+ *    `chunker.min_size` bytes.
+ *
+ * @pre config.threads > 0 and config.segment_size > 0
+ */
+ScanReport scan (gsl::span<const std::filesystem::path> roots,
+                 const ScanConfig& config = {});
+
+}
@@ -0,0 +1,206 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "search.h"
+#include "rolling.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <map>
+
+namespace satz::rabin {
+
+namespace {
+
+// Bytes of haystack that every group slides over before moving on.
+constexpr size_t block_size = 64 * 1024;
+
+// Bits of the bitmap of a group per pattern, and at least.
+constexpr size_t filter_ratio = 16;
+constexpr size_t filter_min   = 512;
+
+}
+
+PatternMatcher::PatternMatcher (
+    FingerprintGenerator fg,
+    gsl::span<const gsl::span<const uint8_t>> patterns)
+    : fg_(std::move(fg)) {
+
+  offsets_.reserve(patterns.size() + 1);
+  offsets_.push_back(0);
+  std::map<size_t, std::vector<std::pair<Fingerprint, uint32_t>>> by_length;
+  for (size_t i = 0; i < size_t(patterns.size()); ++i) {
+    const auto& p = patterns[i];
+    Expects(!p.empty());
+    bytes_.insert(bytes_.end(), p.begin(), p.end());
+    offsets_.push_back(bytes_.size());
+    by_length[p.size()].emplace_back(
+        fg_(Fingerprint(0), p.data(), p.data() + p.size()), uint32_t(i));
+  }
+
+  for (auto& [length, fps] : by_length) {
+    // Patterns with the same fingerprint share an entry of the set.
+    std::sort(fps.begin(), fps.end());
+
+    Group g;
+    g.length = length;
+    g.slots  = slots_.size();
+    g.mask   = std::bit_ceil(2 * fps.size()) - 1;
+    g.filter = filter_.size();
+    g.bits   = std::bit_ceil(std::max(filter_ratio * fps.size(),
+                                      filter_min)) - 1;
+    g.pop    = pop_.size();
+    slots_.resize(slots_.size() + g.mask + 1, Slot{0, 0, 0});
+    filter_.resize(filter_.size() + (g.bits + 1) / 64, 0);
+
+    for (size_t i = 0; i < fps.size();) {
+      const auto begin = uint32_t(ids_.size());
+      const auto fp    = fps[i].first;
+      filter_[g.filter + (fp & g.bits) / 64] |= uint64_t(1) << (fp & 63);
+      for (; i < fps.size() && fps[i].first == fp; ++i) {
+        ids_.push_back(fps[i].second);
+      }
+      size_t s = slot_of(fp, g.mask);
+      while (slots_[g.slots + s].end) s = (s + 1) & g.mask;
+      slots_[g.slots + s] = Slot{fp, begin, uint32_t(ids_.size())};
+    }
+
+    RollingFingerprint rf(fg_, length);
+    for (unsigned int b = 0; b < 256; ++b) {
+      pop_.push_back(rf.pop(Fingerprint(0), uint8_t(b)));
+    }
+    groups_.push_back(g);
+  }
+}
+
+// Reports the patterns of `g` that occur at position `i`, whose window
+// has fingerprint `f`.
+void PatternMatcher::probe (const Group& g,
+                            const uint8_t* h,
+                            size_t i,
+                            Fingerprint f,
+                            std::vector<Match>& out) const {
+  const Slot* slots = slots_.data() + g.slots;
+  for (size_t s = slot_of(f, g.mask); slots[s].end; s = (s + 1) & g.mask) {
+    if (slots[s].fp != f) continue;
+    for (uint32_t k = slots[s].begin; k < slots[s].end; ++k) {
+      const uint32_t id = ids_[k];
+      if (std::memcmp(h + i, bytes_.data() + offsets_[id], g.length) == 0) {
+        out.push_back({i, id});
+      }
+    }
+    return;
+  }
+}
+
+// Slides the windows of the `K` groups at `g` from position `from` to `to`,
+// where `fp` holds the fingerprints of the windows at `from` on entry and
+// at `to` on return. Rolling several windows at once overlaps their chains
+// of table lookups.
+// @pre the window of every group fits at `to` - 1, and past it unless `to`
+//    is the end of the haystack
+template <size_t K>
+void PatternMatcher::scan (const Group* g,
+                           gsl::span<const uint8_t> haystack,
+                           size_t from,
+                           size_t to,
+                           Fingerprint* fp,
+                           std::vector<Match>& out) const {
+  constexpr int shift = sizeof(Fingerprint) * 8 - 8;
+
+  const uint8_t*     h = haystack.data();
+  const Fingerprint* t = fg_.tables().data();
+  const Fingerprint* pop[K];
+  const uint64_t*    bits[K];
+  uint64_t           mask[K];
+  size_t             n[K];
+  Fingerprint        f[K];
+  for (size_t k = 0; k < K; ++k) {
+    pop[k]  = pop_.data() + g[k].pop;
+    bits[k] = filter_.data() + g[k].filter;
+    mask[k] = g[k].bits;
+    n[k]    = g[k].length;
+    f[k]    = fp[k];
+  }
+
+  const auto roll = [&] (size_t k, size_t i) {
+    const Fingerprint x = f[k] ^ pop[k][h[i]];
+    f[k] = ((x << 8) | h[i + n[k]]) ^ t[x >> shift];
+  };
+
+  for (size_t i = from; i < to; ++i) {
+    uint64_t hits = 0;
+    for (size_t k = 0; k < K; ++k) {
+      hits |= (bits[k][(f[k] & mask[k]) / 64] >> (f[k] & 63) & 1) << k;
+    }
+    for (size_t k = 0; hits; ++k, hits >>= 1) {
+      if (hits & 1) probe(g[k], h, i, f[k], out);
+    }
+    if (i + 1 < to) {
+      for (size_t k = 0; k < K; ++k) roll(k, i);
+    } else {
+      // The last window of the haystack has no byte to roll in; that of a
+      // shorter group may still have, and is needed by the next block.
+      for (size_t k = 0; k < K; ++k) {
+        if (i + n[k] < size_t(haystack.size())) roll(k, i);
+      }
+    }
+  }
+
+  for (size_t k = 0; k < K; ++k) fp[k] = f[k];
+}
+
+void PatternMatcher::find (gsl::span<const uint8_t> haystack,
+                           std::vector<Match>& out) const {
+  const size_t n = haystack.size();
+  const auto*  h = haystack.data();
+
+  // Groups are by increasing length, so those whose window fits are a
+  // prefix.
+  size_t G = 0;
+  while (G < groups_.size() && groups_[G].length <= n) ++G;
+
+  std::vector<Fingerprint> fps(G);
+  for (size_t g = 0; g < G; ++g) {
+    fps[g] = fg_(Fingerprint(0), h, h + groups_[g].length);
+  }
+
+  for (size_t from = 0; from < n; from += block_size) {
+    const size_t to    = std::min(n, from + block_size);
+    const size_t first = out.size();
+    for (size_t g = 0; g < G;) {
+      // Near the end of the haystack, the longer windows stop first.
+      const auto end = [&] (size_t k) {
+        return std::min(to, n - groups_[k].length + 1);
+      };
+      if (g + 4 <= G && end(g + 3) == end(g)) {
+        if (from < end(g)) {
+          scan<4>(&groups_[g], haystack, from, end(g), &fps[g], out);
+        }
+        g += 4;
+      } else {
+        if (from < end(g)) {
+          scan<1>(&groups_[g], haystack, from, end(g), &fps[g], out);
+        }
+        g += 1;
+      }
+    }
+    std::sort(out.begin() + first, out.end(),
+              [] (const Match& a, const Match& b) {
+                return a.position != b.position ? a.position < b.position
+                                                : a.pattern < b.pattern;
+              });
+  }
+}
+
+std::vector<PatternMatcher::Match> PatternMatcher::find (
+    gsl::span<const uint8_t> haystack) const {
+  std::vector<Match> ret;
+  find(haystack, ret);
+  return ret;
+}
+
+}
@@ -0,0 +1,112 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Rabin-Karp search for many patterns at once.
+ *
+ *    Patterns are grouped by length. A window of each distinct length
+ *    slides over the haystack, and its fingerprint is looked up in an
+ *    open-addressing set of the fingerprints of the patterns of that
+ *    length; a hit is confirmed by comparing the bytes, so a match is never
+ *    reported falsely. A bitmap with a bit set for one in sixteen
+ *    fingerprints or fewer screens the windows before the set is probed,
+ *    which keeps the branches of the scan predictable. The cost per byte
+ *    grows with the number of distinct lengths, not with the number of
+ *    patterns.
+ *
+ *    The haystack is scanned in blocks small enough to stay in cache while
+ *    every group slides over it, four groups at a time.
+ */
+class PatternMatcher {
+public:
+  struct Match {
+    size_t position; // offset of the match in the haystack
+    size_t pattern;  // index of the pattern
+
+    friend bool operator == (const Match& a, const Match& b) {
+      return a.position == b.position && a.pattern == b.pattern;
+    }
+  };
+
+  /**
+   * @param fg fingerprint generator
+   * @param patterns patterns to search for; the matcher keeps a copy
+   * @pre no pattern is empty
+   */
+  PatternMatcher (FingerprintGenerator fg,
+                  gsl::span<const gsl::span<const uint8_t>> patterns);
+
+  [[nodiscard]] size_t size () const {return offsets_.size() - 1;}
+
+  [[nodiscard]] gsl::span<const uint8_t> pattern (size_t i) const {
+    return {bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+  }
+
+  /**
+   * @brief Appends every occurrence of every pattern in `haystack` to `out`,
+   *    ordered by position, then by pattern index.
+   */
+  void find (gsl::span<const uint8_t> haystack, std::vector<Match>& out) const;
+
+  [[nodiscard]] std::vector<Match> find (
+      gsl::span<const uint8_t> haystack) const;
+
+private:
+  // An entry of the fingerprint set of a group: the patterns with this
+  // fingerprint are `ids_[begin, end)`. Empty entries have `end == 0`.
+  struct Slot {
+    Fingerprint fp;
+    uint32_t    begin;
+    uint32_t    end;
+  };
+
+  struct Group {
+    size_t   length;
+    size_t   slots;  // offset of the fingerprint set in `slots_`
+    uint64_t mask;   // number of entries in the set, minus 1
+    size_t   filter; // offset of the bitmap in `filter_`
+    uint64_t bits;   // number of bits in the bitmap, minus 1
+    size_t   pop;    // offset of the pop table in `pop_`
+  };
+
+  void probe (const Group& g,
+              const uint8_t* h,
+              size_t i,
+              Fingerprint f,
+              std::vector<Match>& out) const;
+
+  template <size_t K>
+  void scan (const Group* g,
+             gsl::span<const uint8_t> haystack,
+             size_t from,
+             size_t to,
+             Fingerprint* fp,
+             std::vector<Match>& out) const;
+
+  static size_t slot_of (Fingerprint fp, uint64_t mask) {
+    return size_t((fp * 0x9e3779b97f4a7c15ull) >> 32 & mask);
+  }
+
+  FingerprintGenerator     fg_;
+  std::vector<uint8_t>     bytes_;   // patterns, end to end
+  std::vector<size_t>      offsets_; // pattern i starts at offsets_[i]
+  std::vector<Group>       groups_;
+  std::vector<Slot>        slots_;
+  std::vector<uint32_t>    ids_;
+  std::vector<uint64_t>    filter_;
+  // `pop_[g.pop + b]` drops byte `b` from a window of length `g.length`.
+  std::vector<Fingerprint> pop_;
+};
+
+}
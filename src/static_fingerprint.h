@@ -0,0 +1,62 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "kernels.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief A fingerprint generator whose polynomial is fixed at compile time.
+ *
+ *    The lookup tables are computed by the compiler and live in read-only
+ *    data, so there is nothing to build at runtime, and the table address
+ *    is a constant the kernels can fold into their loads. Fingerprints
+ *    equal those of `FingerprintGenerator(Poly)`.
+ *
+ * @tparam Poly the bit representation of an irreducible polynomial of
+ *    degree 64, with the leading bit removed; not checked.
+ */
+template <Fingerprint Poly>
+class StaticFingerprintGenerator
+    : public FingerprintKernels<StaticFingerprintGenerator<Poly>,
+                                Fingerprint> {
+public:
+  static_assert(Poly != 0);
+
+  /**
+   * @brief Returns the polynomial in the form taken by `FingerprintGenerator`.
+   */
+  static constexpr Fingerprint polynomial () {return Poly;}
+
+private:
+  friend class FingerprintKernels<StaticFingerprintGenerator, Fingerprint>;
+
+  static constexpr Fingerprint modulus () {return Poly;}
+
+  static constexpr const Fingerprint* lookup () {return lookup_.data();}
+
+  static constexpr const Fingerprint* clmul_constants () {
+    return clmul_.data();
+  }
+
+  static constexpr std::array<Fingerprint, detail::lookup_rows * 256>
+      lookup_ = [] {
+    std::array<Fingerprint, detail::lookup_rows * 256> t{};
+    detail::build_lookup(Poly, t.data());
+    return t;
+  }();
+
+  static constexpr std::array<Fingerprint, 9> clmul_ = [] {
+    std::array<Fingerprint, 9> k{};
+    detail::build_clmul_constants(Poly, lookup_.data(), k.data());
+    return k;
+  }();
+};
+
+}
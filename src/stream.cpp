@@ -0,0 +1,31 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "stream.h"
+
+namespace satz::rabin {
+
+FingerprintStream& FingerprintStream::update_slow (
+    gsl::span<const uint8_t> bytes) {
+
+  flush();
+  length_ += bytes.size();
+
+  // Large writes bypass the buffer.
+  if (size_t(bytes.size()) >= buffer_size) {
+    fp_ = (*fg_)(fp_, bytes.data(), bytes.data() + bytes.size());
+  } else {
+    std::copy_n(bytes.data(), bytes.size(), buffer_.data());
+    used_ = bytes.size();
+  }
+  return *this;
+}
+
+void FingerprintStream::flush () {
+  fp_ = (*fg_)(fp_, buffer_.data(), buffer_.data() + used_);
+  used_ = 0;
+}
+
+}
@@ -0,0 +1,114 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <gsl/gsl>
+#include "fingerprint.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Incremental fingerprint of a byte stream fed in pieces.
+ *
+ *    Writes are collected in an internal buffer, which is flushed through
+ *    the byte-range kernels of the generator once it fills up, so that a
+ *    long sequence of small writes costs about as much as one large one.
+ *    The digest equals the fingerprint of all bytes written so far, in
+ *    order, computed by the generator from the initial fingerprint.
+ *
+ *    The stream refers to its generator, which must outlive it.
+ */
+class FingerprintStream {
+public:
+  /**
+   * @param fg fingerprint generator
+   * @param fp initial fingerprint
+   */
+  explicit FingerprintStream (const FingerprintGenerator& fg,
+                              Fingerprint fp = Fingerprint(~0))
+      : fg_(&fg), fp_(fp) { }
+
+  /**
+   * @brief Appends a byte string.
+   */
+  FingerprintStream& update (gsl::span<const uint8_t> bytes) {
+    const size_t n = bytes.size();
+    if (used_ + n <= buffer_size) {
+      std::copy_n(bytes.data(), n, buffer_.data() + used_);
+      used_ += n;
+      length_ += n;
+      return *this;
+    }
+    return update_slow(bytes);
+  }
+
+  /**
+   * @brief Appends the bytes of a scalar, most significant first, like
+   *    `FingerprintGenerator::operator()`.
+   */
+  template <typename T>
+    requires std::is_scalar_v<T>
+  FingerprintStream& update (T value) {
+    constexpr size_t n = sizeof(T);
+
+    if (used_ + n > buffer_size) flush();
+    auto bytes = std::bit_cast<std::array<uint8_t, n>>(value);
+    uint8_t* p = buffer_.data() + used_;
+    if constexpr (std::endian::native == std::endian::little) {
+      for (size_t i = 0; i < n; ++i) p[i] = bytes[n - 1 - i];
+    } else {
+      std::memcpy(p, bytes.data(), n);
+    }
+    used_ += n;
+    length_ += n;
+    return *this;
+  }
+
+  /**
+   * @brief Returns the fingerprint of the bytes written so far.
+   */
+  [[nodiscard]] Fingerprint digest () const {
+    return (*fg_)(fp_, buffer_.data(), buffer_.data() + used_);
+  }
+
+  /**
+   * @brief Returns the number of bytes written so far.
+   */
+  [[nodiscard]] uint64_t length () const {return length_;}
+
+  [[nodiscard]] const FingerprintGenerator& generator () const {return *fg_;}
+
+  /**
+   * @brief Starts a new stream from the given initial fingerprint.
+   */
+  void reset (Fingerprint fp = Fingerprint(~0)) {
+    fp_ = fp;
+    used_ = 0;
+    length_ = 0;
+  }
+
+private:
+  // Large enough for the carry-less multiplication kernel to pay off.
+  static constexpr size_t buffer_size = 512;
+
+  FingerprintStream& update_slow (gsl::span<const uint8_t> bytes);
+
+  void flush ();
+
+  const FingerprintGenerator* fg_;
+  Fingerprint                 fp_;
+  size_t                      used_   = 0;
+  uint64_t                    length_ = 0;
+  alignas(64) std::array<uint8_t, buffer_size> buffer_;
+};
+
+}
@@ -0,0 +1,78 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#include "winnow.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace satz::rabin {
+
+Winnower::Winnower (FingerprintGenerator fg, WinnowConfig config)
+    : config_(config),
+      rolling_(std::move(fg), config.k),
+      kgram_(config.k, 0) {
+
+  Expects(config_.k > 0 && config_.window > 0);
+
+  // A new k-gram joins the deque before the expired one leaves it.
+  deque_.resize(std::bit_ceil(config_.window + 1));
+  mask_ = deque_.size() - 1;
+}
+
+void Winnower::reset () {
+  head_   = 0;
+  length_ = 0;
+  fp_     = 0;
+  front_  = 0;
+  size_   = 0;
+  last_   = ~uint64_t(0);
+}
+
+void Winnower::select (gsl::span<const uint8_t> document,
+                       std::vector<Selection>& out) {
+  auto emit = [&out] (const Selection& s) { out.push_back(s); };
+  reset();
+  update(document, emit);
+  finish(emit);
+}
+
+std::vector<Selection> Winnower::select (gsl::span<const uint8_t> document) {
+  std::vector<Selection> ret;
+  select(document, ret);
+  return ret;
+}
+
+void signature (gsl::span<const Selection> selections,
+                std::vector<Fingerprint>& out) {
+  out.resize(selections.size());
+  std::transform(selections.begin(), selections.end(), out.begin(),
+                 [] (const Selection& s) { return s.fp; });
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+double resemblance (gsl::span<const Fingerprint> a,
+                    gsl::span<const Fingerprint> b) {
+  if (a.empty() && b.empty()) return 1.0;
+
+  size_t common = 0;
+  auto   i = a.begin();
+  auto   j = b.begin();
+  while (i != a.end() && j != b.end()) {
+    if (*i < *j) {
+      ++i;
+    } else if (*j < *i) {
+      ++j;
+    } else {
+      ++common;
+      ++i;
+      ++j;
+    }
+  }
+  return double(common) / double(a.size() + b.size() - common);
+}
+
+}
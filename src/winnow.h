@@ -0,0 +1,162 @@
+//
+// Created by robin on 2026/10/17.
+// Copyright (c) 2026 Robin. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <gsl/gsl>
+#include "fingerprint.h"
+#include "rolling.h"
+
+namespace satz::rabin {
+
+/**
+ * @brief Parameters of winnowing.
+ *
+ *    Every substring of at least `k + window - 1` bytes shared by two
+ *    documents yields a fingerprint common to both, and no match shorter
+ *    than `k` bytes does. About 2 / (window + 1) of the k-grams are
+ *    selected.
+ */
+struct WinnowConfig {
+  size_t k      = 32; // bytes per k-gram
+  size_t window = 16; // k-grams per window
+};
+
+/**
+ * @brief Fingerprint of a selected k-gram, and the offset of its first
+ *    byte in the document.
+ */
+struct Selection {
+  Fingerprint fp;
+  uint64_t    position;
+
+  friend bool operator == (const Selection& a, const Selection& b) {
+    return a.fp == b.fp && a.position == b.position;
+  }
+};
+
+/**
+ * @brief Selects document fingerprints by winnowing (Schleimer, Wilkerson
+ *    and Aiken, 2003).
+ *
+ *    The fingerprints of all k-grams of a document are computed with a
+ *    rolling window. Of every `window` consecutive k-grams, the one with
+ *    the smallest fingerprint is selected, the rightmost one on ties, and
+ *    each k-gram is reported once however many windows select it. The
+ *    minima are tracked with a monotone deque, so that a document of $n$
+ *    bytes takes $O(n)$ time whatever the window. A document with at
+ *    least one k-gram but fewer than `window` yields its smallest one.
+ *
+ *    A winnower reads a document in pieces of any size, and allocates
+ *    nothing after its construction. It is not thread-safe; use one per
+ *    thread.
+ */
+class Winnower {
+public:
+  /**
+   * @pre config.k > 0 and config.window > 0
+   */
+  explicit Winnower (FingerprintGenerator fg, WinnowConfig config = {});
+
+  [[nodiscard]] const WinnowConfig& config () const {return config_;}
+
+  /**
+   * @brief Starts a new document.
+   */
+  void reset ();
+
+  /**
+   * @brief Reads the next bytes of the document and calls `f(selection)`
+   *    for every k-gram selected so far, in increasing position.
+   */
+  template <typename F>
+  void update (gsl::span<const uint8_t> bytes, F f) {
+    for (uint8_t in : bytes) {
+      const uint8_t out = kgram_[head_];
+      kgram_[head_] = in;
+      head_ = head_ + 1 == config_.k ? 0 : head_ + 1;
+
+      fp_ = length_ < config_.k ? rolling_.push(fp_, in)
+                                : rolling_.roll(fp_, out, in);
+      if (++length_ < config_.k) continue;
+      if (auto s = push(fp_, length_ - config_.k)) f(*s);
+    }
+  }
+
+  /**
+   * @brief Ends the document; calls `f` with the smallest k-gram of a
+   *    document too short to fill a window, if any. The winnower is then
+   *    ready for the next document.
+   */
+  template <typename F>
+  void finish (F f) {
+    if (length_ >= config_.k && length_ - config_.k + 1 < config_.window) {
+      f(deque_[front_]);
+    }
+    reset();
+  }
+
+  /**
+   * @brief Winnows a whole document, appending its selections to `out`;
+   *    `out` only grows if its capacity is too small.
+   */
+  void select (gsl::span<const uint8_t> document, std::vector<Selection>& out);
+
+  [[nodiscard]] std::vector<Selection> select (
+      gsl::span<const uint8_t> document);
+
+private:
+  // Adds the k-gram at `position` to the current window, and returns the
+  // minimum of the window if it is newly selected.
+  std::optional<Selection> push (Fingerprint fp, uint64_t position) {
+    // The deque holds the candidates for the minimum of this window or a
+    // later one, with increasing fingerprints from front to back.
+    while (size_ && deque_[(front_ + size_ - 1) & mask_].fp >= fp) --size_;
+    deque_[(front_ + size_) & mask_] = Selection{fp, position};
+    ++size_;
+    if (deque_[front_].position + config_.window <= position) {
+      front_ = (front_ + 1) & mask_;
+      --size_;
+    }
+
+    if (position + 1 < config_.window) return {};
+    const Selection& min = deque_[front_];
+    if (min.position == last_) return {};
+    last_ = min.position;
+    return min;
+  }
+
+  WinnowConfig           config_;
+  RollingFingerprint     rolling_;
+  std::vector<uint8_t>   kgram_;  // the last k bytes, a ring from head_
+  std::vector<Selection> deque_;  // a ring of a power of two entries
+  uint64_t               mask_;
+  size_t                 head_   = 0;
+  uint64_t               length_ = 0; // bytes of the document so far
+  Fingerprint            fp_     = 0;
+  size_t                 front_  = 0;
+  size_t                 size_   = 0;
+  uint64_t               last_   = ~uint64_t(0); // last selected position
+};
+
+/**
+ * @brief Returns the fingerprints of `selections`, sorted and without
+ *    duplicates, in `out`, which only grows if its capacity is too small.
+ */
+void signature (gsl::span<const Selection> selections,
+                std::vector<Fingerprint>& out);
+
+/**
+ * @brief Estimates the resemblance of two documents, the Jaccard index of
+ *    their signatures: $|A \cap B| / |A \cup B|$, or 1 if both are empty.
+ * @pre a and b are sorted and without duplicates, as made by `signature`
+ */
+[[nodiscard]] double resemblance (gsl::span<const Fingerprint> a,
+                                  gsl::span<const Fingerprint> b);
+
+}